@@ -0,0 +1,198 @@
+#!/usr/bin/python
+"""
+Benchmark suite for kDP, kDPF and kDPFC on fixed subsets of the bundled data.
+
+Every instance is run with a pinned seed and thread count. Per run we record
+wall time, peak resident set size, CPLEX time, separation time and objective
+value. Results are written to a JSON file and compared against a stored
+baseline; runs whose wall time, CPLEX time or peak RSS grew by more than the
+threshold (or whose objective changed) are reported as regressions.
+"""
+from __future__ import print_function
+import argparse
+import json
+import os
+import platform
+import re
+import subprocess
+import sys
+import tempfile
+import time
+
+# stratified subset of data/k_dollo: (m, n, k, loss), seed 1
+K_DOLLO = [(25, 25, 1, 0.1), (25, 25, 2, 0.4),
+           (50, 25, 1, 0.4), (50, 50, 1, 0.1),
+           (50, 50, 2, 0.2), (100, 50, 1, 0.1),
+           (100, 50, 2, 0.4), (100, 100, 1, 0.2)]
+
+# stratified subset of data/flip: (seed, loss), m = n = 50, k = 1
+FLIP = [(1, 0.1), (1, 0.4), (2, 0.2), (3, 0.1)]
+
+ALPHA = 0.001
+BETA = 0.2
+SEED = 0
+RESTARTS = 2
+
+
+def instances(data, threads):
+    res = []
+    t = ["-t", str(threads)]
+
+    for m, n, k, loss in K_DOLLO:
+        name = "m%d_n%d_s1_k%d_loss%s" % (m, n, k, loss)
+        res.append(("kDP/" + name, "kDP",
+                    ["-k", str(k)] + t + [os.path.join(data, "k_dollo", name + ".B")]))
+
+    for s, loss in FLIP:
+        name = "m50_n50_s%d_k1_loss%s_a%s_b%s" % (s, loss, ALPHA, BETA)
+        filename = os.path.join(data, "flip", name + ".B")
+        flip = ["-k", "1", "-a", str(ALPHA), "-b", str(BETA)] + t
+        res.append(("kDPF/ilp/" + name, "kDPF", flip + [filename]))
+        res.append(("kDPF/cg/" + name, "kDPF", ["-c"] + flip + [filename]))
+        res.append(("kDPFC/" + name, "kDPFC",
+                    flip + ["-lT", "10", "-lC", "10", "-N", str(RESTARTS),
+                            "-s", str(SEED), filename]))
+
+    res.append(("kDPFC/CRC1", "kDPFC",
+                ["-k", "1", "-a", "0.0152", "-b", "0.0789"] + t +
+                ["-lT", "10", "-lC", "15", "-N", str(RESTARTS), "-s", str(SEED),
+                 os.path.join(data, "CRC", "CRC1.SPhyR.input")]))
+    return res
+
+
+def parse_log(log):
+    cplex_time = sum(float(x) for x in re.findall(r"^CPLEX time: (\S+)", log, re.M))
+    separation_time = sum(float(x) for x in re.findall(r"^Separation time: (\S+)", log, re.M))
+
+    objective = None
+    likelihood = re.findall(r"^Solution likelihood: (\S+)", log, re.M)
+    if likelihood:
+        objective = float(likelihood[-1])
+    else:
+        bounds = re.findall(r"^CPLEX: \[(\S+) , (\S+)\]", log, re.M)
+        if bounds:
+            objective = float(bounds[-1][0])
+
+    return cplex_time, separation_time, objective
+
+
+def run(executable, args, timeout):
+    with tempfile.TemporaryFile() as out, tempfile.TemporaryFile() as err:
+        start = time.time()
+        proc = subprocess.Popen([executable] + args, stdout=out, stderr=err)
+        pid, status, rusage = os.wait4(proc.pid, 0) if timeout <= 0 else wait_timeout(proc, timeout)
+        status = os.WEXITSTATUS(status) if os.WIFEXITED(status) else -os.WTERMSIG(status)
+        proc.returncode = status
+        wall = time.time() - start
+
+        err.seek(0)
+        log = err.read().decode("utf-8", "replace")
+
+    cplex_time, separation_time, objective = parse_log(log)
+    return {
+        "status": status,
+        "wall": wall,
+        # ru_maxrss is in kilobytes on Linux and in bytes on macOS
+        "rss_mb": rusage.ru_maxrss / (1024. * 1024. if sys.platform == "darwin" else 1024.),
+        "cplex_time": cplex_time,
+        "separation_time": separation_time,
+        "objective": objective,
+    }
+
+
+def wait_timeout(proc, timeout):
+    deadline = time.time() + timeout
+    while True:
+        pid, status, rusage = os.wait4(proc.pid, os.WNOHANG)
+        if pid != 0:
+            return pid, status, rusage
+        if time.time() > deadline:
+            proc.kill()
+            return os.wait4(proc.pid, 0)
+        time.sleep(0.05)
+
+
+def compare(results, baseline, threshold, min_time):
+    regressions = []
+    for name, res in sorted(results.items()):
+        if name not in baseline:
+            continue
+        base = baseline[name]
+        if res["status"] != 0 and base["status"] == 0:
+            regressions.append("%s: run failed (status %d)" % (name, res["status"]))
+            continue
+        for key in ("wall", "cplex_time", "separation_time", "rss_mb"):
+            old, new = base.get(key), res.get(key)
+            if old is None or new is None:
+                continue
+            if key != "rss_mb" and new < min_time:
+                continue
+            if new > old * (1 + threshold):
+                regressions.append("%s: %s %.3f -> %.3f (%+.1f%%)"
+                                   % (name, key, old, new, 100. * (new - old) / max(old, 1e-9)))
+        old, new = base.get("objective"), res.get("objective")
+        if old is not None and (new is None or abs(new - old) > 1e-6 * max(1., abs(old))):
+            regressions.append("%s: objective %s -> %s" % (name, old, new))
+    return regressions
+
+
+if __name__ == "__main__":
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+    parser = argparse.ArgumentParser(description=__doc__.strip().split("\n")[0])
+    parser.add_argument("--bin", default=os.path.join(root, "build"), help="directory containing kDP, kDPF and kDPFC")
+    parser.add_argument("--data", default=os.path.join(root, "data"), help="data directory")
+    parser.add_argument("--baseline", default=os.path.join(root, "result", "bench_baseline.json"), help="baseline JSON")
+    parser.add_argument("--output", default="bench.json", help="output JSON")
+    parser.add_argument("--threshold", type=float, default=0.2, help="relative slowdown flagged as regression (default: 0.2)")
+    parser.add_argument("--min-time", type=float, default=0.5, help="ignore timings below this many seconds (default: 0.5)")
+    parser.add_argument("--threads", type=int, default=1, help="number of threads (default: 1)")
+    parser.add_argument("--timeout", type=int, default=0, help="per run timeout in seconds (default: 0, unlimited)")
+    parser.add_argument("--filter", default="", help="only run instances whose name contains this string")
+    parser.add_argument("--update-baseline", action="store_true", help="write results to the baseline file")
+    args = parser.parse_args()
+
+    results = {}
+    for name, executable, exe_args in instances(args.data, args.threads):
+        if args.filter not in name:
+            continue
+        res = run(os.path.join(args.bin, executable), exe_args, args.timeout)
+        results[name] = res
+        print("%-50s %3s %9.3f s %9.1f MB  cplex %9.3f s  sep %8.3f s  obj %s"
+              % (name, "ok" if res["status"] == 0 else "ERR", res["wall"], res["rss_mb"],
+                 res["cplex_time"], res["separation_time"], res["objective"]))
+        sys.stdout.flush()
+
+    report = {
+        "host": platform.node(),
+        "platform": platform.platform(),
+        "threads": args.threads,
+        "date": time.strftime("%Y-%m-%d %H:%M:%S"),
+        "runs": results,
+    }
+    with open(args.output, "w") as f:
+        json.dump(report, f, indent=2, sort_keys=True)
+
+    if args.update_baseline:
+        with open(args.baseline, "w") as f:
+            json.dump(report, f, indent=2, sort_keys=True)
+        print("Baseline written to '%s'" % args.baseline)
+        sys.exit(0)
+
+    if not os.path.exists(args.baseline):
+        print("No baseline '%s', run with --update-baseline to create one" % args.baseline)
+        sys.exit(0)
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    if baseline.get("threads") != args.threads or baseline.get("host") != platform.node():
+        print("Warning: baseline was recorded on '%s' with %s threads"
+              % (baseline.get("host"), baseline.get("threads")))
+
+    regressions = compare(results, baseline["runs"], args.threshold, args.min_time)
+    if regressions:
+        print("\n%d regression(s) beyond %.0f%%:" % (len(regressions), 100 * args.threshold))
+        for r in regressions:
+            print("  " + r)
+        sys.exit(1)
+    print("\nNo regressions beyond %.0f%%" % (100 * args.threshold))
@@ -0,0 +1,129 @@
+#!/usr/bin/python
+"""
+Tune a solver profile for kDP, kDPF or kDPFC on a set of training instances.
+
+Candidate profiles are the built-in profiles (balanced, fast, proof) followed
+by either random samples or the full grid of the selected parameters. Every
+candidate is run on all training instances via the -profile option. A run
+counts as solved if it terminates successfully within the timeout and, if the
+balanced profile solved the instance, attains the same objective value.
+Candidates are ranked by penalized total wall time, where an unsolved run
+costs twice the timeout (PAR2). The best profile is written in the format
+read by -profile.
+"""
+from __future__ import print_function
+import argparse
+import itertools
+import os
+import random
+import shlex
+import sys
+import tempfile
+
+from bench import run
+
+# parameter values explored, see src/solverprofile.h; mipgap is not tuned as
+# it changes the optimal objective value
+SPACE = {
+    "emphasis": [0, 1, 2, 3, 4],
+    "cuts": [-1, 0, 1, 2],
+    "probe": [-1, 0, 1, 2, 3],
+    "heuristicfreq": [-1, 0, 5, 20],
+    "varsel": [-1, 0, 1, 2, 3, 4],
+}
+
+# built-in profiles, see SolverProfile::getBuiltinProfile
+BUILTIN = [("balanced", {}),
+           ("fast", {"emphasis": 1, "cuts": -1, "probe": -1, "heuristicfreq": 5}),
+           ("proof", {"emphasis": 3, "cuts": 2, "probe": 3, "varsel": 3})]
+
+
+def write_profile(filename, name, params):
+    with open(filename, "w") as f:
+        f.write("# %s\n" % name)
+        for key in sorted(params):
+            f.write("%s %s\n" % (key, params[key]))
+
+
+def candidates(search, keys, trials, rng):
+    grid = list(itertools.product(*[SPACE[key] for key in keys]))
+    if search == "random":
+        rng.shuffle(grid)
+        grid = grid[:trials]
+    for values in grid:
+        yield dict(zip(keys, values))
+
+
+def evaluate(executable, exe_args, instances, profile, timeout, reference):
+    total = 0.
+    solved = 0
+    objectives = []
+    for instance in instances:
+        res = run(executable, exe_args + ["-profile", profile, instance], timeout)
+        ok = res["status"] == 0 and (timeout <= 0 or res["wall"] <= timeout)
+        ref = reference.get(instance) if reference else None
+        if ok and ref is not None:
+            obj = res["objective"]
+            ok = obj is not None and abs(obj - ref) <= 1e-6 * max(1., abs(ref))
+        objectives.append(res["objective"] if ok else None)
+        if ok:
+            solved += 1
+            total += res["wall"]
+        else:
+            total += 2 * timeout if timeout > 0 else float("inf")
+    return total, solved, objectives
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__.strip().split("\n")[0])
+    parser.add_argument("instances", nargs="+", help="training instances")
+    parser.add_argument("--executable", required=True, help="kDP, kDPF or kDPFC executable")
+    parser.add_argument("--args", default="", help="additional arguments, e.g. \"-c -k 1 -a 0.001 -b 0.2\"")
+    parser.add_argument("--search", choices=["random", "grid"], default="random", help="search strategy (default: random)")
+    parser.add_argument("--params", default=",".join(sorted(SPACE)), help="comma separated parameters to tune (default: all)")
+    parser.add_argument("--trials", type=int, default=20, help="number of random candidates (default: 20)")
+    parser.add_argument("--timeout", type=int, default=600, help="per run timeout in seconds (default: 600)")
+    parser.add_argument("--seed", type=int, default=0, help="random number generator seed (default: 0)")
+    parser.add_argument("--output", default="tuned.profile", help="output profile (default: tuned.profile)")
+    args = parser.parse_args()
+
+    keys = [key for key in args.params.split(",") if key]
+    for key in keys:
+        if key not in SPACE:
+            sys.exit("Error: unknown parameter '%s'" % key)
+
+    exe_args = shlex.split(args.args)
+    rng = random.Random(args.seed)
+    tmpdir = tempfile.mkdtemp()
+
+    reference = {}
+    best = None
+    trial = 0
+    for name, params in BUILTIN:
+        total, solved, objectives = evaluate(args.executable, exe_args, args.instances,
+                                             name, args.timeout, reference)
+        if name == "balanced":
+            reference = dict((instance, obj) for instance, obj in zip(args.instances, objectives)
+                             if obj is not None)
+        print("%-40s solved %d/%d  score %.3f" % (name, solved, len(args.instances), total))
+        sys.stdout.flush()
+        if best is None or total < best[0]:
+            best = (total, name, params)
+
+    for params in candidates(args.search, keys, args.trials, rng):
+        trial += 1
+        name = "trial%d" % trial
+        filename = os.path.join(tmpdir, name + ".profile")
+        write_profile(filename, name, params)
+        total, solved, _ = evaluate(args.executable, exe_args, args.instances,
+                                    filename, args.timeout, reference)
+        print("%-40s solved %d/%d  score %.3f  %s"
+              % (name, solved, len(args.instances), total,
+                 " ".join("%s=%s" % (key, params[key]) for key in sorted(params))))
+        sys.stdout.flush()
+        if total < best[0]:
+            best = (total, name, params)
+
+    total, name, params = best
+    write_profile(args.output, "%s, score %.3f" % (name, total), params)
+    print("\nBest profile: %s (score %.3f) written to '%s'" % (name, total, args.output))
@@ -7,28 +7,377 @@
 
 #include <lemon/arg_parser.h>
 #include <fstream>
+#include <sstream>
+#include <mutex>
+#include <map>
+#include <memory>
 #include "matrix.h"
 #include "comparison.h"
 #include "dollophylogenetictree.h"
 
+/// Column names of the statistics written by analyze()
+const char* const HEADER = "RF,norm_RF,anc_loss_recall,inc_loss_recall,cls_loss_recall,anc_recall,inc_recall,cls_recall,taxa_RI,taxa_recall,taxa_precision,char_RI,char_recall,char_precision,L,back_mut_inf,par_evo_inf,back_mut_true,par_evo_true,loss_recall,loss_precision,loss_F1,flip01_correct,flip01_incorrect,flip10_correct,flip10_incorrect,TN,FN,FP,TP,ones,zeros,inTN,inFN,inFP,inTP,flip?1_correct,flip?1_incorrect,flip?0_correct,flip?0_incorrect";
+
+/// Number of columns of a batch manifest: method, m, n, s, k, loss, alpha,
+/// beta, time, inferred, true and input; an optional last column indicates
+/// whether the inferred solution is a tree (1) or a matrix (0)
+const size_t MANIFEST_COLUMNS = 12;
+
+/// Write comma-separated statistics of an inferred solution
+///
+/// @param inferredT Inferred phylogenetic tree
+/// @param trueT True phylogenetic tree
+/// @param inputB Input matrix
+/// @param alpha False positive rate
+/// @param beta False negative rate
+/// @param splitSets Compute RF distance from explicit split sets
+/// @param out Output stream
+void analyze(const PhylogeneticTree& inferredT,
+             const PhylogeneticTree& trueT,
+             const Matrix& inputB,
+             double alpha,
+             double beta,
+             bool splitSets,
+             std::ostream& out)
+{
+  Comparison compare(trueT, inferredT, splitSets);
+  
+  double ancestralLossRecall, incomparableLossRecall, clusteredLossRecall;
+  compare.recallCharStatePairs(ancestralLossRecall, incomparableLossRecall, clusteredLossRecall, false);
+  
+  double ancestralRecall, incomparableRecall, clusteredRecall;
+  compare.recallCharStatePairs(ancestralRecall, incomparableRecall, clusteredRecall, true);
+  
+  double taxaRI, taxaRecall, taxaPrecision;
+  compare.getTaxaClusteringMetrics(taxaRI, taxaRecall, taxaPrecision);
+  
+  double charactersRI, charactersRecall, charactersPrecision;
+  compare.getCharactersClusteringMetrics(charactersRI, charactersRecall, charactersPrecision);
+  
+  Matrix trueB = trueT.getMatrixB();
+  Matrix inferredB = inferredT.getMatrixB();
+
+  double logLikelihood = inputB.getLogLikelihood(inferredB, alpha, beta);
+  double lossPrecision = 0;
+  double lossRecall = 0;
+  double lossF1 = 0;
+  compare.computeLossPrecisionAndRecall(lossPrecision, lossRecall, lossF1);
+  
+  int flip01_correct, flip10_correct, flip01_incorrect, flip10_incorrect;
+  int flipx1_correct, flipx0_correct, flipx1_incorrect, flipx0_incorrect;
+  compare.computeFlips(inputB, flip01_correct, flip01_incorrect, flip10_correct, flip10_incorrect,
+                       flipx1_correct, flipx1_incorrect, flipx0_correct, flipx0_incorrect);
+  
+  int TN, FN, FP, TP;
+  inferredB.inferConfusionMatrix(trueB, TN, FN, FP, TP);
+  
+  int inTN, inFN, inFP, inTP;
+  inputB.inferConfusionMatrix(trueB, inTN, inFN, inFP, inTP);
+  
+  // 4. RF
+  // 5. normalized RF
+  // 6. ancestral pairs recall
+  // 7. incomparable pairs recall
+  // 8. clustered pairs recall
+  // 9. taxa Rand index
+  // 10. taxa recall
+  // 11. taxa precision
+  // 12. character Rand index
+  // 13. character recall
+  // 14. character precision
+  // 15. likelihood
+  // 16. back mutation count (inferred)
+  // 17. parallel evolution count (inferred)
+  // 16. back mutation count (true)
+  // 17. parallel evolution count (true)
+  // 19. output matrix accuracy
+  // 20. input matrix accuracy
+  // 21. output matrix fraction of incorrect 0s
+  // 22. input matrix fraction of incorrect 0s
+  // 23. output matrix fraction of incorrect 1s
+  // 24. input matrix fraction of incorrect 1s
+  out << compare.getRF() << ","
+      << compare.getNormalizedRF() << ","
+      << ancestralLossRecall << ","
+      << incomparableLossRecall << ","
+      << clusteredLossRecall << ","
+      << ancestralRecall << ","
+      << incomparableRecall << ","
+      << clusteredRecall << ","
+      << taxaRI << ","
+      << taxaRecall << ","
+      << taxaPrecision << ","
+      << charactersRI << ","
+      << charactersRecall << ","
+      << charactersPrecision << ","
+      << logLikelihood << ","
+      << inferredT.getBackMutationCount() << ","
+      << inferredT.getParallelEvolutionCount() << ","
+      << trueT.getBackMutationCount() << ","
+      << trueT.getParallelEvolutionCount() << ","
+      << lossRecall << ","
+      << lossPrecision << ","
+      << lossF1 << ","
+      << flip01_correct << ","
+      << flip01_incorrect << ","
+      << flip10_correct << ","
+      << flip10_incorrect << ","
+      << TN << ","
+      << FN << ","
+      << FP << ","
+      << TP << ","
+      << inputB.getCount(1) << ","
+      << inputB.getCount(0) << ","
+      << inTN << ","
+      << inFN << ","
+      << inFP << ","
+      << inTP << ","
+      << flipx1_correct << ","
+      << flipx1_incorrect << ","
+      << flipx0_correct << ","
+      << flipx0_incorrect
+      << std::endl;
+}
+
+/// Row of a batch manifest
+struct Task
+{
+  /// Leading columns copied to the output
+  std::string _key;
+  /// Inferred solution file
+  std::string _inferredFilename;
+  /// Index of true solution
+  int _trueIndex;
+  /// Index of input matrix
+  int _inputIndex;
+  /// False positive rate
+  double _alpha;
+  /// False negative rate
+  double _beta;
+  /// Inferred solution is a tree instead of a matrix
+  bool _tree;
+  /// Manifest line number
+  int _lineNumber;
+};
+
+/// Return index of filename, adding it if it is new
+///
+/// @param filename Filename
+/// @param filenames Filenames
+/// @param index Map from filename to index
+int getIndex(const std::string& filename,
+             StringVector& filenames,
+             std::map<std::string, int>& index)
+{
+  auto it = index.find(filename);
+  if (it != index.end())
+  {
+    return it->second;
+  }
+  index[filename] = filenames.size();
+  filenames.push_back(filename);
+  return filenames.size() - 1;
+}
+
+/// Analyze all triples of a manifest, returns exit code. True solutions and
+/// input matrices that occur in several rows are parsed and reconstructed once.
+///
+/// @param manifestFilename Manifest file
+/// @param nrThreads Number of threads
+/// @param tree Default type of inferred solutions
+/// @param header Print header
+/// @param splitSets Compute RF distance from explicit split sets
+int analyzeBatch(const std::string& manifestFilename,
+                 int nrThreads,
+                 bool tree,
+                 bool header,
+                 bool splitSets)
+{
+  std::ifstream in(manifestFilename.c_str());
+  if (!in.good())
+  {
+    std::cerr << "Error: could not open '" << manifestFilename << "' for reading" << std::endl;
+    return 1;
+  }
+  
+  std::vector<Task> tasks;
+  StringVector trueFilenames, inputFilenames;
+  std::map<std::string, int> trueIndex, inputIndex;
+  
+  g_lineNumber = 0;
+  std::string line;
+  while (in.good())
+  {
+    getline(in, line);
+    boost::trim(line);
+    if (line.empty() || line[0] == '#')
+      continue;
+    
+    StringVector s;
+    boost::split(s, line, boost::is_any_of(","));
+    if (s.size() != MANIFEST_COLUMNS && s.size() != MANIFEST_COLUMNS + 1)
+    {
+      std::cerr << getLineNumber() << "Error: expected " << MANIFEST_COLUMNS
+                << " or " << MANIFEST_COLUMNS + 1 << " columns" << std::endl;
+      return 1;
+    }
+    
+    Task task;
+    task._key = s[0];
+    for (int i = 1; i < 9; ++i)
+    {
+      task._key += "," + s[i];
+    }
+    task._inferredFilename = s[9];
+    task._trueIndex = getIndex(s[10], trueFilenames, trueIndex);
+    task._inputIndex = getIndex(s[11], inputFilenames, inputIndex);
+    task._tree = s.size() > MANIFEST_COLUMNS ? s[12] == "1" : tree;
+    task._lineNumber = g_lineNumber;
+    try
+    {
+      task._alpha = std::stod(s[6]);
+      task._beta = std::stod(s[7]);
+    }
+    catch (std::logic_error&)
+    {
+      std::cerr << getLineNumber() << "Error: invalid alpha or beta" << std::endl;
+      return 1;
+    }
+    tasks.push_back(task);
+  }
+  
+  std::mutex mutex;
+  auto reportError = [&](const std::string& msg)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::cerr << msg << std::endl;
+  };
+  
+  // parsed trees and matrices are shared read-only by the workers below
+  std::vector<std::unique_ptr<DolloPhylogeneticTree>> trueTrees(trueFilenames.size());
+  parallelForDynamic(trueFilenames.size(), nrThreads, [&](int i)
+  {
+    try
+    {
+      // the pool is already parallel, reconstruct each tree sequentially
+      trueTrees[i].reset(DolloPhylogeneticTree::parse(trueFilenames[i], 1));
+    }
+    catch (std::runtime_error& e)
+    {
+      reportError(e.what());
+    }
+  });
+  
+  std::vector<std::unique_ptr<Matrix>> inputs(inputFilenames.size());
+  parallelForDynamic(inputFilenames.size(), nrThreads, [&](int i)
+  {
+    try
+    {
+      inputs[i].reset(Matrix::parse(inputFilenames[i]));
+    }
+    catch (std::runtime_error& e)
+    {
+      reportError(e.what());
+    }
+  });
+  
+  std::vector<std::string> results(tasks.size());
+  parallelForDynamic(tasks.size(), nrThreads, [&](int i)
+  {
+    const Task& task = tasks[i];
+    const PhylogeneticTree* pTrueT = trueTrees[task._trueIndex].get();
+    const Matrix* pInputB = inputs[task._inputIndex].get();
+    if (!pTrueT || !pInputB)
+    {
+      reportError("Error: skipping manifest line " + std::to_string(task._lineNumber));
+      return;
+    }
+    
+    std::unique_ptr<PhylogeneticTree> pInferredT;
+    try
+    {
+      if (task._tree)
+      {
+        pInferredT.reset(PhylogeneticTree::parse(task._inferredFilename));
+      }
+      else
+      {
+        pInferredT.reset(DolloPhylogeneticTree::parse(task._inferredFilename, 1));
+      }
+      
+      if (pInferredT)
+      {
+        std::stringstream ss;
+        ss << task._key << ",";
+        analyze(*pInferredT, *pTrueT, *pInputB,
+                task._alpha, task._beta, splitSets, ss);
+        results[i] = ss.str();
+      }
+    }
+    catch (std::runtime_error& e)
+    {
+      reportError(e.what());
+    }
+    
+    if (results[i].empty())
+    {
+      reportError("Error: skipping manifest line " + std::to_string(task._lineNumber));
+    }
+  });
+  
+  if (header)
+  {
+    std::cout << "method,m,n,s,k,loss,alpha,beta,time," << HEADER << std::endl;
+  }
+  
+  bool success = true;
+  for (const std::string& result : results)
+  {
+    if (result.empty())
+    {
+      success = false;
+    }
+    std::cout << result;
+  }
+  
+  return success ? 0 : 1;
+}
+
 int main(int argc, char** argv)
 {
   double alpha = 1e-3;
   double beta = 0.3;
   bool tree = false;
   bool header = false;
+  bool splitSets = false;
+  std::string manifest;
+  int nrThreads = 1;
+  bool countOnly = false;
+  bool summary = false;
+  int maxNrViolations = -1;
   
   lemon::ArgParser ap(argc, argv);
   ap.refOption("a", "False positive rate (default: 1e-3)", alpha)
     .refOption("b", "False negative rate (default: 0.3)", beta)
     .refOption("T", "Use tree instead of matrix", tree)
     .refOption("H", "Print header", header)
+    .refOption("S", "Compute RF distance from explicit split sets (slow)", splitSets)
+    .refOption("count-only", "Only print the number of violations of a single matrix", countOnly)
+    .refOption("max", "Stop after the given number of violations (default: -1, unlimited)", maxNrViolations)
+    .refOption("summary", "Print number of violations per character pair instead of each violation", summary)
+    .refOption("batch", "Analyze all rows 'method,m,n,s,k,loss,alpha,beta,time,inferred,true,input[,T]' of the given manifest", manifest)
+    .refOption("t", "Number of threads (default: 1)", nrThreads)
     .other("inferred", "Inferred solution file")
     .other("true", "True solution file")
     .other("input", "Input matrix");
   
   ap.parse();
   
+  if (!manifest.empty())
+  {
+    return analyzeBatch(manifest, nrThreads, tree, header, splitSets);
+  }
+  
   if (ap.files().empty())
   {
     std::cerr << "Error: input file missing" << std::endl;
@@ -37,44 +386,92 @@ int main(int argc, char** argv)
   
   if (ap.files().size() == 1)
   {
-    Matrix::ViolationList list;
     Matrix* pInferredA = Matrix::parse(ap.files()[0]);
     if (!pInferredA)
     {
       return 1;
     }
-    pInferredA->identifyViolations(pInferredA->getMaxNrLosses(), list);
     
-    IntPairSet violationEntries;
-    for (const Matrix::Violation& violation : list)
-    {
-      std::cout << "Condition " << violation._condition
-                << " ; " << "p = " << violation._p << " ; q = " << violation._q
-                << " ; r = " << violation._r << " ; c = " << violation._c
-                << " ; d = " << violation._d << std::endl;
-      std::cout << pInferredA->getEntry(violation._p, violation._c)
-                << " " << pInferredA->getEntry(violation._p, violation._d)
-                << std::endl;
-      std::cout << pInferredA->getEntry(violation._q, violation._c)
-                << " " << pInferredA->getEntry(violation._q, violation._d)
-                << std::endl;
-      std::cout << pInferredA->getEntry(violation._r, violation._c)
-                << " " << pInferredA->getEntry(violation._r, violation._d)
-                << std::endl;
-      std::cout << std::endl;
-      violationEntries.insert(IntPair(violation._p, violation._c));
-      violationEntries.insert(IntPair(violation._q, violation._c));
-      violationEntries.insert(IntPair(violation._r, violation._c));
-      violationEntries.insert(IntPair(violation._p, violation._d));
-      violationEntries.insert(IntPair(violation._q, violation._d));
-      violationEntries.insert(IntPair(violation._r, violation._d));
+    const int m = pInferredA->getNrTaxa();
+    const int n = pInferredA->getNrCharacters();
+    
+    // violations are streamed, memory is bounded by a bit per entry
+    std::vector<bool> violatedEntries(m * n, false);
+    long long nrViolatedEntries = 0;
+    auto markEntry = [&](int p, int c)
+    {
+      if (!violatedEntries[p * n + c])
+      {
+        violatedEntries[p * n + c] = true;
+        ++nrViolatedEntries;
+      }
+    };
+    
+    // violations arrive grouped by character pair
+    IntPair pair(-1, -1);
+    long long nrPairViolations = 0;
+    auto flushPair = [&]()
+    {
+      if (nrPairViolations > 0)
+      {
+        std::cout << "Characters " << pair.first << " and " << pair.second
+                  << ": " << nrPairViolations << " violations" << std::endl;
+      }
+    };
+    
+    long long nrViolations = 0;
+    bool complete = pInferredA->identifyViolations(pInferredA->getMaxNrLosses(),
+                                                   [&](const Matrix::Violation& violation)
+    {
+      if (summary && IntPair(violation._c, violation._d) != pair)
+      {
+        flushPair();
+        pair = IntPair(violation._c, violation._d);
+        nrPairViolations = 0;
+      }
+      ++nrPairViolations;
+      ++nrViolations;
+      
+      if (!countOnly && !summary)
+      {
+        std::cout << "Condition " << violation._condition
+                  << " ; " << "p = " << violation._p << " ; q = " << violation._q
+                  << " ; r = " << violation._r << " ; c = " << violation._c
+                  << " ; d = " << violation._d << std::endl;
+        std::cout << pInferredA->getEntry(violation._p, violation._c)
+                  << " " << pInferredA->getEntry(violation._p, violation._d)
+                  << std::endl;
+        std::cout << pInferredA->getEntry(violation._q, violation._c)
+                  << " " << pInferredA->getEntry(violation._q, violation._d)
+                  << std::endl;
+        std::cout << pInferredA->getEntry(violation._r, violation._c)
+                  << " " << pInferredA->getEntry(violation._r, violation._d)
+                  << std::endl;
+        std::cout << std::endl;
+      }
+      markEntry(violation._p, violation._c);
+      markEntry(violation._q, violation._c);
+      markEntry(violation._r, violation._c);
+      markEntry(violation._p, violation._d);
+      markEntry(violation._q, violation._d);
+      markEntry(violation._r, violation._d);
+      
+      return maxNrViolations <= 0 || nrViolations < maxNrViolations;
+    });
+    if (summary)
+    {
+      flushPair();
     }
     
-    std::cout << "Total number of violations: " << list.size() << std::endl;
-    std::cout << "Violated entries: " << violationEntries.size()
-              << " / " << pInferredA->getNrTaxa() * pInferredA->getNrCharacters()
-              << " = " << (double) violationEntries.size() /
-                (pInferredA->getNrTaxa() * pInferredA->getNrCharacters())
+    std::cout << "Total number of violations: " << nrViolations;
+    if (!complete)
+    {
+      std::cout << " (stopped at -max)";
+    }
+    std::cout << std::endl;
+    std::cout << "Violated entries: " << nrViolatedEntries
+              << " / " << m * n
+              << " = " << (double) nrViolatedEntries / (m * n)
               << std::endl;
     
     for (int c = 0; c < pInferredA->getNrCharacters(); ++c)
@@ -99,7 +496,7 @@ int main(int argc, char** argv)
     }
     else
     {
-      pInferredT = DolloPhylogeneticTree::parse(ap.files()[0]);
+      pInferredT = DolloPhylogeneticTree::parse(ap.files()[0], nrThreads);
     }
     
     if (!pInferredT)
@@ -107,7 +504,7 @@ int main(int argc, char** argv)
       return 1;
     }
     
-    PhylogeneticTree* pTrueT = DolloPhylogeneticTree::parse(ap.files()[1]);
+    PhylogeneticTree* pTrueT = DolloPhylogeneticTree::parse(ap.files()[1], nrThreads);
     if (!pTrueT)
     {
       return 1;
@@ -119,108 +516,11 @@ int main(int argc, char** argv)
       return 1;
     }
     
-    Comparison compare(*pTrueT, *pInferredT);
-    
-    double ancestralLossRecall, incomparableLossRecall, clusteredLossRecall;
-    compare.recallCharStatePairs(ancestralLossRecall, incomparableLossRecall, clusteredLossRecall, false);
-    
-    double ancestralRecall, incomparableRecall, clusteredRecall;
-    compare.recallCharStatePairs(ancestralRecall, incomparableRecall, clusteredRecall, true);
-    
-    double taxaRI, taxaRecall, taxaPrecision;
-    compare.getTaxaClusteringMetrics(taxaRI, taxaRecall, taxaPrecision);
-    
-    double charactersRI, charactersRecall, charactersPrecision;
-    compare.getCharactersClusteringMetrics(charactersRI, charactersRecall, charactersPrecision);
-    
-    Matrix trueB = pTrueT->getMatrixB();
-    Matrix inferredB = pInferredT->getMatrixB();
-
-    double logLikelihood = pInputB->getLogLikelihood(inferredB, alpha, beta);
-    double lossPrecision = 0;
-    double lossRecall = 0;
-    double lossF1 = 0;
-    compare.computeLossPrecisionAndRecall(lossPrecision, lossRecall, lossF1);
-    
-    int flip01_correct, flip10_correct, flip01_incorrect, flip10_incorrect;
-    int flipx1_correct, flipx0_correct, flipx1_incorrect, flipx0_incorrect;
-    compare.computeFlips(*pInputB, flip01_correct, flip01_incorrect, flip10_correct, flip10_incorrect,
-                         flipx1_correct, flipx1_incorrect, flipx0_correct, flipx0_incorrect);
-    
-    int TN, FN, FP, TP;
-    inferredB.inferConfusionMatrix(trueB, TN, FN, FP, TP);
-    
-    int inTN, inFN, inFP, inTP;
-    pInputB->inferConfusionMatrix(trueB, inTN, inFN, inFP, inTP);
-    
     if (header)
     {
-      std::cout << "RF,norm_RF,anc_loss_recall,inc_loss_recall,cls_loss_recall,anc_recall,inc_recall,cls_recall,taxa_RI,taxa_recall,taxa_precision,char_RI,char_recall,char_precision,L,back_mut_inf,par_evo_inf,back_mut_true,par_evo_true,loss_recall,loss_precision,loss_F1,flip01_correct,flip01_incorrect,flip10_correct,flip10_incorrect,TN,FN,FP,TP,ones,zeros,inTN,inFN,inFP,inTP,flip?1_correct,flip?1_incorrect,flip?0_correct,flip?0_incorrect" << std::endl;
+      std::cout << HEADER << std::endl;
     }
-    
-    // 4. RF
-    // 5. normalized RF
-    // 6. ancestral pairs recall
-    // 7. incomparable pairs recall
-    // 8. clustered pairs recall
-    // 9. taxa Rand index
-    // 10. taxa recall
-    // 11. taxa precision
-    // 12. character Rand index
-    // 13. character recall
-    // 14. character precision
-    // 15. likelihood
-    // 16. back mutation count (inferred)
-    // 17. parallel evolution count (inferred)
-    // 16. back mutation count (true)
-    // 17. parallel evolution count (true)
-    // 19. output matrix accuracy
-    // 20. input matrix accuracy
-    // 21. output matrix fraction of incorrect 0s
-    // 22. input matrix fraction of incorrect 0s
-    // 23. output matrix fraction of incorrect 1s
-    // 24. input matrix fraction of incorrect 1s
-    std::cout << compare.getRF() << ","
-              << compare.getNormalizedRF() << ","
-              << ancestralLossRecall << ","
-              << incomparableLossRecall << ","
-              << clusteredLossRecall << ","
-              << ancestralRecall << ","
-              << incomparableRecall << ","
-              << clusteredRecall << ","
-              << taxaRI << ","
-              << taxaRecall << ","
-              << taxaPrecision << ","
-              << charactersRI << ","
-              << charactersRecall << ","
-              << charactersPrecision << ","
-              << logLikelihood << ","
-              << pInferredT->getBackMutationCount() << ","
-              << pInferredT->getParallelEvolutionCount() << ","
-              << pTrueT->getBackMutationCount() << ","
-              << pTrueT->getParallelEvolutionCount() << ","
-              << lossRecall << ","
-              << lossPrecision << ","
-              << lossF1 << ","
-              << flip01_correct << ","
-              << flip01_incorrect << ","
-              << flip10_correct << ","
-              << flip10_incorrect << ","
-              << TN << ","
-              << FN << ","
-              << FP << ","
-              << TP << ","
-              << pInputB->getCount(1) << ","
-              << pInputB->getCount(0) << ","
-              << inTN << ","
-              << inFN << ","
-              << inFP << ","
-              << inTP << ","
-              << flipx1_correct << ","
-              << flipx1_incorrect << ","
-              << flipx0_correct << ","
-              << flipx0_incorrect
-              << std::endl;
+    analyze(*pInferredT, *pTrueT, *pInputB, alpha, beta, splitSets, std::cout);
   }
   
   return 0;
@@ -0,0 +1,169 @@
+/*
+ * budget.cpp
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#include "budget.h"
+#include <ctime>
+#include <sys/resource.h>
+
+Budget::Budget(double wallTimeLimit,
+               double cpuTimeLimit,
+               double tickLimit,
+               double solverTickLimit,
+               int memoryLimit)
+  : _wallTimeLimit(wallTimeLimit)
+  , _cpuTimeLimit(cpuTimeLimit)
+  , _tickLimit(tickLimit)
+  , _solverTickLimit(solverTickLimit)
+  , _memoryLimit(memoryLimit)
+  , _wallStart(Clock::now())
+  , _cpuStart(getProcessCpuTime())
+  , _ticks(0)
+  , _solverTicks(0)
+  , _lastPoll(0)
+  , _status(WITHIN_BUDGET)
+{
+}
+
+bool Budget::tick(double ticks)
+{
+  double current = _ticks.load();
+  while (!_ticks.compare_exchange_weak(current, current + ticks));
+  current += ticks;
+
+  if (_status.load() != WITHIN_BUDGET)
+  {
+    return false;
+  }
+  if (_tickLimit > 0 && current > _tickLimit)
+  {
+    setStatus(TICKS_EXCEEDED);
+    return false;
+  }
+
+  double lastPoll = _lastPoll.load();
+  if (current - lastPoll >= CHECK_INTERVAL
+      && _lastPoll.compare_exchange_strong(lastPoll, current))
+  {
+    return check() == WITHIN_BUDGET;
+  }
+  return true;
+}
+
+bool Budget::tickSolver(double ticks)
+{
+  double current = _solverTicks.load();
+  while (!_solverTicks.compare_exchange_weak(current, current + ticks));
+  
+  // solver ticks are charged once per solve, so all limits are polled
+  return check() == WITHIN_BUDGET;
+}
+
+Budget::Status Budget::check()
+{
+  if (_status.load() == WITHIN_BUDGET)
+  {
+    if (_wallTimeLimit > 0 && getWallTime() > _wallTimeLimit)
+    {
+      setStatus(WALL_TIME_EXCEEDED);
+    }
+    else if (_cpuTimeLimit > 0 && getCpuTime() > _cpuTimeLimit)
+    {
+      setStatus(CPU_TIME_EXCEEDED);
+    }
+    else if (_tickLimit > 0 && getTicks() > _tickLimit)
+    {
+      setStatus(TICKS_EXCEEDED);
+    }
+    else if (_solverTickLimit > 0 && getSolverTicks() > _solverTickLimit)
+    {
+      setStatus(SOLVER_TICKS_EXCEEDED);
+    }
+    else if (_memoryLimit > 0 && getPeakMemory() > _memoryLimit)
+    {
+      setStatus(MEMORY_EXCEEDED);
+    }
+  }
+  return static_cast<Status>(_status.load());
+}
+
+double Budget::getWallTime() const
+{
+  return std::chrono::duration<double>(Clock::now() - _wallStart).count();
+}
+
+double Budget::getRemainingTime(int nrThreads) const
+{
+  double res = -1;
+  if (_wallTimeLimit > 0)
+  {
+    res = std::max(0., _wallTimeLimit - getWallTime());
+  }
+  if (_cpuTimeLimit > 0)
+  {
+    double cpu = std::max(0., _cpuTimeLimit - getCpuTime()) / std::max(nrThreads, 1);
+    res = res < 0 ? cpu : std::min(res, cpu);
+  }
+  return res;
+}
+
+double Budget::getRemainingTicks() const
+{
+  if (_tickLimit > 0)
+  {
+    return std::max(0., _tickLimit - getTicks());
+  }
+  return -1;
+}
+
+double Budget::getRemainingSolverTicks() const
+{
+  if (_solverTickLimit > 0)
+  {
+    return std::max(0., _solverTickLimit - getSolverTicks());
+  }
+  return -1;
+}
+
+const char* Budget::toString(Status status)
+{
+  switch (status)
+  {
+    case WITHIN_BUDGET:
+      return "Within budget";
+    case WALL_TIME_EXCEEDED:
+      return "Time limit exceeded";
+    case CPU_TIME_EXCEEDED:
+      return "CPU time limit exceeded";
+    case TICKS_EXCEEDED:
+      return "Tick limit exceeded";
+    case SOLVER_TICKS_EXCEEDED:
+      return "Solver tick limit exceeded";
+    case MEMORY_EXCEEDED:
+      return "Memory limit exceeded";
+    case CANCELLED:
+      return "Cancelled";
+  }
+  return "";
+}
+
+double Budget::getProcessCpuTime()
+{
+  return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+}
+
+int Budget::getPeakMemory()
+{
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  // bytes on macOS
+  return usage.ru_maxrss / (1024 * 1024);
+#else
+  // kilobytes on Linux
+  return usage.ru_maxrss / 1024;
+#endif // __APPLE__
+}
@@ -0,0 +1,170 @@
+/*
+ * budget.h
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#ifndef BUDGET_H
+#define BUDGET_H
+
+#include <atomic>
+#include <chrono>
+#include "utils.h"
+
+/// This class models the resources a run may consume.
+///
+/// A budget limits wall-clock time, process CPU time, deterministic ticks,
+/// deterministic solver ticks and peak resident set size. Ticks are SPhyR's
+/// own units of work: one tick is one matrix entry, solution value or
+/// k-means coordinate visited, or one model variable or row created.
+/// Solver ticks are the deterministic time reported by the MIP solver (e.g.
+/// CPLEX ticks), which is not convertible to ticks and is therefore
+/// accounted and limited separately. Both stop a run at the same point
+/// irrespective of machine load. Solvers poll the budget cooperatively; once
+/// a limit is exceeded, the budget stays exceeded. A budget may be shared
+/// by threads.
+class Budget
+{
+public:
+  /// Budget status
+  enum Status
+  {
+    WITHIN_BUDGET,
+    WALL_TIME_EXCEEDED,
+    CPU_TIME_EXCEEDED,
+    TICKS_EXCEEDED,
+    SOLVER_TICKS_EXCEEDED,
+    MEMORY_EXCEEDED,
+    CANCELLED
+  };
+
+  /// Constructor, non-positive limits are unlimited
+  ///
+  /// @param wallTimeLimit Wall-clock time limit in seconds
+  /// @param cpuTimeLimit CPU time limit in seconds
+  /// @param tickLimit Deterministic tick limit
+  /// @param solverTickLimit Deterministic solver tick limit
+  /// @param memoryLimit Peak resident set size limit in megabytes
+  Budget(double wallTimeLimit,
+         double cpuTimeLimit,
+         double tickLimit,
+         double solverTickLimit,
+         int memoryLimit);
+
+  /// Account for work, returns false if the budget is exceeded. Clocks and
+  /// memory are polled at most once every CHECK_INTERVAL ticks.
+  ///
+  /// @param ticks Number of ticks
+  bool tick(double ticks = 1);
+
+  /// Account for deterministic time spent by the MIP solver, returns false
+  /// if the budget is exceeded
+  ///
+  /// @param ticks Number of solver ticks
+  bool tickSolver(double ticks);
+
+  /// Poll all limits and return status
+  Status check();
+
+  /// Return whether the budget is exceeded
+  bool exceeded()
+  {
+    return check() != WITHIN_BUDGET;
+  }
+
+  /// Cancel run, may be called from another thread
+  void cancel()
+  {
+    setStatus(CANCELLED);
+  }
+
+  /// Return remaining time in seconds for a solve with the given number of
+  /// threads, -1 if unlimited. CPU time is assumed to accrue at most
+  /// nrThreads times as fast as wall-clock time.
+  ///
+  /// @param nrThreads Number of threads
+  double getRemainingTime(int nrThreads) const;
+
+  /// Return remaining ticks, -1 if unlimited
+  double getRemainingTicks() const;
+
+  /// Return remaining solver ticks, -1 if unlimited
+  double getRemainingSolverTicks() const;
+
+  /// Return elapsed wall-clock time in seconds
+  double getWallTime() const;
+
+  /// Return elapsed CPU time in seconds
+  double getCpuTime() const
+  {
+    return getProcessCpuTime() - _cpuStart;
+  }
+
+  /// Return consumed ticks
+  double getTicks() const
+  {
+    return _ticks.load();
+  }
+
+  /// Return consumed solver ticks
+  double getSolverTicks() const
+  {
+    return _solverTicks.load();
+  }
+
+  /// Return status description
+  ///
+  /// @param status Status
+  static const char* toString(Status status);
+
+  /// Return CPU time of this process in seconds
+  static double getProcessCpuTime();
+
+  /// Return peak resident set size of this process in megabytes
+  static int getPeakMemory();
+
+  /// Number of ticks between polls of clocks and memory
+  static const long long CHECK_INTERVAL = 1 << 16;
+
+private:
+  Budget(const Budget&);
+  Budget& operator=(const Budget&);
+
+  /// Set status unless it was already set
+  ///
+  /// @param status Status
+  void setStatus(Status status)
+  {
+    int expected = WITHIN_BUDGET;
+    _status.compare_exchange_strong(expected, status);
+  }
+
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  /// Wall-clock time limit in seconds
+  const double _wallTimeLimit;
+  /// CPU time limit in seconds
+  const double _cpuTimeLimit;
+  /// Tick limit
+  const double _tickLimit;
+  /// Solver tick limit
+  const double _solverTickLimit;
+  /// Peak resident set size limit in megabytes
+  const int _memoryLimit;
+  /// Wall-clock start
+  const Clock::time_point _wallStart;
+  /// CPU time at construction
+  const double _cpuStart;
+  /// Consumed ticks
+  std::atomic<double> _ticks;
+  /// Consumed solver ticks
+  std::atomic<double> _solverTicks;
+  /// Ticks at the last poll
+  std::atomic<double> _lastPoll;
+  /// Status
+  std::atomic<int> _status;
+};
+
+#endif // BUDGET_H
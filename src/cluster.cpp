@@ -8,6 +8,33 @@
 #include "cluster.h"
 #include "dkm/dkm.hpp"
 
+/// Lloyd's k-means with k-means++ initialization as in dkm::kmeans_lloyd,
+/// additionally stopping once stop() returns true after an iteration.
+/// Returns the cluster of each data point.
+///
+/// @param data Data points
+/// @param k Number of clusters
+/// @param seed Random number generator seed
+/// @param stop Stop predicate
+template<typename T, typename Stop>
+static std::vector<uint32_t> kmeansLloyd(const std::vector<std::vector<T> >& data,
+                                         uint32_t k,
+                                         uint32_t seed,
+                                         Stop stop)
+{
+  std::vector<std::vector<T> > means = dkm::details::random_plusplus(data, k, seed);
+  std::vector<std::vector<T> > oldMeans;
+  std::vector<uint32_t> clusters;
+  do
+  {
+    clusters = dkm::details::calculate_clusters(data, means);
+    oldMeans = means;
+    means = dkm::details::calculate_means(data, clusters, oldMeans, k, oldMeans[0].size());
+  } while (means != oldMeans && !stop());
+  
+  return clusters;
+}
+
 Cluster::Cluster(const Matrix& D,
                  int lT,
                  int lC)
@@ -19,7 +46,7 @@ Cluster::Cluster(const Matrix& D,
 {
 }
 
-void Cluster::cluster(int seed)
+void Cluster::cluster(int seed, Budget* budget)
 {
   // kMeans
   const int m = _D.getNrTaxa();
@@ -48,7 +75,9 @@ void Cluster::cluster(int seed)
     // }
   }
   
-  auto z = std::get<1>(dkm::kmeans_lloyd(data, _t, seed));
+  // each iteration compares the n characters with the _t means in m coordinates
+  auto stopC = [&]() { return budget && !budget->tick(1. * n * _t * m); };
+  auto z = kmeansLloyd(data, _t, seed, stopC);
   for (int c = 0; c < n; ++c)
   {
     _zC[c] = z[c];
@@ -77,7 +106,8 @@ void Cluster::cluster(int seed)
     // }
   }
   
-  auto z2 = std::get<1>(dkm::kmeans_lloyd(data2, _s, seed));
+  auto stopT = [&]() { return budget && !budget->tick(1. * m * _s * n); };
+  auto z2 = kmeansLloyd(data2, _s, seed, stopT);
   for (int p = 0; p < m; ++p)
   {
     _zT[p] = z2[p];
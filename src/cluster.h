@@ -10,6 +10,7 @@
 
 #include "utils.h"
 #include "matrix.h"
+#include "budget.h"
 
 /// This class models k-Means clustering of the character and taxon set
 class Cluster
@@ -27,7 +28,9 @@ public:
   /// Cluster
   ///
   /// @param seed Random number generator seed
-  void cluster(int seed);
+  /// @param budget Budget charged per Lloyd iteration, iteration stops early
+  /// once it is exceeded
+  void cluster(int seed, Budget* budget = NULL);
   
   /// Return character cluster assignment
   const StlIntVector& getCharacterMapping() const
@@ -6,8 +6,8 @@
  */
 
 #include "columngen.h"
-#include <ilconcert/ilothread.h>
-#include "dollocallback.h"
+#include "forbiddenpatterns.h"
+#include <stdexcept>
 
 ColumnGen::ColumnGen(const Matrix& B,
                      int k,
@@ -17,15 +17,17 @@ ColumnGen::ColumnGen(const Matrix& B,
   , _n(B.getNrCharacters())
   , _k(k)
   , _lazy(lazy)
-  , _env()
-  , _model(_env)
-  , _cplex(_model)
-  , _A(_env)
-  , _vars(_env)
-  , _obj(_env)
+  , _backendName(MipBackend::getDefaultBackend())
+  , _profile()
+  , _budget(NULL)
+  , _backend()
+  , _aborted(false)
+  , _hotStartProvider()
   , _activeVariables()
   , _nrActiveVariables(0)
   , _nrConstraints(0)
+  , _recordConstraints(false)
+  , _separatedConstraints()
   , _solA(_B.getNrTaxa(), _B.getNrCharacters())
 {
 }
@@ -40,27 +42,67 @@ ColumnGen::ColumnGen(const Matrix& B,
   , _n(n)
   , _k(k)
   , _lazy(lazy)
-  , _env()
-  , _model(_env)
-  , _cplex(_model)
-  , _A(_env)
-  , _vars(_env)
-  , _obj(_env)
+  , _backendName(MipBackend::getDefaultBackend())
+  , _profile()
+  , _budget(NULL)
+  , _backend()
+  , _aborted(false)
+  , _hotStartProvider()
   , _activeVariables()
   , _nrActiveVariables(0)
   , _nrConstraints(0)
+  , _recordConstraints(false)
+  , _separatedConstraints()
   , _solA(m, n)
 {
 }
 
 void ColumnGen::init()
 {
+  _backend.reset(MipBackend::create(_backendName));
+  if (!_backend)
+  {
+    throw std::runtime_error("Error: MIP backend '" + _backendName + "' is not available");
+  }
+  
   initVariables();
   initConstraints();
   initFixedColumns();
   initFixedEntriesConstraints();
   initActiveVariables();
   initObjective();
+  
+  if (_budget)
+  {
+    _budget->tick(_backend->getNrVariables() + _backend->getNrRows());
+  }
+}
+
+void ColumnGen::initHotStart(const Matrix& A)
+{
+  StlIntVector startVar;
+  StlDoubleVector startVal;
+  
+  for (int p = 0; p < _m; ++p)
+  {
+    for (int c = 0; c < _n; ++c)
+    {
+      for (int i = 0; i <= _k + 1; ++i)
+      {
+        startVar.push_back(getIndex(p, c, i));
+        startVal.push_back(i == A.getEntry(p, c) ? 1 : 0);
+        
+        if (A.getEntry(p, c) == i && !_activeVariables[p][c][i])
+        {
+          _activeVariables[p][c][i] = true;
+          _backend->setUpperBound(getIndex(p, c, i), 1);
+          ++_nrActiveVariables;
+        }
+      }
+    }
+  }
+  
+  _backend->addMIPStart(startVar, startVal);
 }
 
 void ColumnGen::writeActiveVariables(std::ostream& out) const
@@ -125,20 +167,19 @@ void ColumnGen::initObjective()
 {
   double factor = 1. / (_m * _n);
   
+  StlDoubleVector obj(_backend->getNrVariables(), 0.);
   for (int p = 0; p < _m; ++p)
   {
     for (int c = 0; c < _n; ++c)
     {
       for (int i = 2; i <= _k + 1; ++i)
       {
-        _obj += pow(factor, _k + 1 - i) * _A[p][c][i];
+        obj[getIndex(p, c, i)] += 1000 * pow(factor, _k + 1 - i);
       }
     }
   }
   
-  _obj *= 1000;
-  
-  _model.add(IloMinimize(_env, _obj));
+  _backend->setObjective(obj, 0, false);
 }
 
 void ColumnGen::updateVariableBounds()
@@ -149,19 +190,21 @@ void ColumnGen::updateVariableBounds()
     {
       for (int i = 0; i <= _k + 1; ++i)
       {
-        if (_activeVariables[p][c][i])
-        {
-          _A[p][c][i].setUB(1);
-        }
-        else
-        {
-          _A[p][c][i].setUB(0);
-        }
+        _backend->setUpperBound(getIndex(p, c, i), _activeVariables[p][c][i] ? 1 : 0);
       }
     }
   }
 }
 
+void ColumnGen::fixVariable(int p, int c, int i, int value)
+{
+  MipBackend::Row row;
+  row._vars.push_back(getIndex(p, c, i));
+  row._coefs.push_back(1);
+  row._lb = row._ub = value;
+  _backend->addRow(row);
+}
+
 void ColumnGen::initFixedColumns()
 {
   for (int c = 0; c < _n; c++)
@@ -193,11 +236,11 @@ void ColumnGen::initFixedColumns()
       {
         if (_B.getEntry(p, c) == 1)
         {
-          _model.add(_A[p][c][1] == 1);
+          fixVariable(p, c, 1, 1);
         }
         else
         {
-          _model.add(_A[p][c][0] == 1);
+          fixVariable(p, c, 0, 1);
         }
       }
     }
@@ -205,14 +248,14 @@ void ColumnGen::initFixedColumns()
     {
       for (int p = 0; p < _m; p++)
       {
-        _model.add(_A[p][c][1] == 1);
+        fixVariable(p, c, 1, 1);
       }
     }
     else if (nrZeros + nrMissing == _m)
     {
       for (int p = 0; p < _m; p++)
       {
-        _model.add(_A[p][c][0] == 1);
+        fixVariable(p, c, 0, 1);
       }
     }
   }
@@ -227,11 +270,11 @@ void ColumnGen::initFixedEntriesConstraints()
       int b_pc = _B.getEntry(p, c);
       if (b_pc == 1)
       {
-        _model.add(_A[p][c][1] == 1);
+        fixVariable(p, c, 1, 1);
       }
       else if (b_pc == 0)
       {
-        _model.add(_A[p][c][1] == 0);
+        fixVariable(p, c, 1, 0);
       }
     }
   }
@@ -239,62 +282,58 @@ void ColumnGen::initFixedEntriesConstraints()
 
 void ColumnGen::initConstraints()
 {
-  IloExpr sum(_env);
-  
   // Each entry has a unique state
+  MipBackend::Row sum;
+  sum._lb = sum._ub = 1;
   for (int p = 0; p < _m; p++)
   {
     for (int c = 0; c < _n; c++)
     {
+      sum._vars.clear();
       for (int i = 0; i <= _k + 1; ++i)
       {
-        sum += _A[p][c][i];
+        sum._vars.push_back(getIndex(p, c, i));
       }
-      _model.add(sum == 1);
-      sum.clear();
+      sum._coefs.assign(_k + 2, 1.);
+      _backend->addRow(sum);
     }
   }
   
-  IloExpr prevSum(_env);
+  // Number of losses i - 1 is at least number of losses i
+  MipBackend::Row diff;
+  diff._lb = 0;
+  diff._ub = MipBackend::INF;
   for (int c = 0; c < _n; c++)
   {
-    for (int i = 2; i <= _k + 1; ++i)
+    for (int i = 3; i <= _k + 1; ++i)
     {
+      diff._vars.clear();
+      diff._coefs.clear();
       for (int p = 0; p < _m; p++)
       {
-        sum += _A[p][c][i];
-      }
-      if (i > 2)
-      {
-        _model.add(prevSum >= sum);
+        diff._vars.push_back(getIndex(p, c, i - 1));
+        diff._coefs.push_back(1);
+        diff._vars.push_back(getIndex(p, c, i));
+        diff._coefs.push_back(-1);
       }
-      
-      std::swap(prevSum, sum);
-      sum.clear();
+      _backend->addRow(diff);
     }
   }
-  
-  sum.end();
-  prevSum.end();
 }
 
 void ColumnGen::initVariables()
 {
   char buf[1024];
   
-  _A = IloBoolVar3Matrix(_env, _m);
-  _vars = IloBoolVarArray(_env, _m * _n * (_k + 2));
   for (int p = 0; p < _m; p++)
   {
-    _A[p] = IloBoolVarMatrix(_env, _n);
     for (int c = 0; c < _n; ++c)
     {
-      _A[p][c] = IloBoolVarArray(_env, _k + 2);
       for (int i = 0; i < _k + 2; ++i)
       {
         snprintf(buf, 1024, "a_%d_%d_%d", p, c, i);
-        _A[p][c][i] = IloBoolVar(_env, buf);
-        _vars[getIndex(p, c, i)] = _A[p][c][i];
+        int var = _backend->addBinaryVariable(buf);
+        assert(var == getIndex(p, c, i));
       }
     }
   }
@@ -309,7 +348,7 @@ void ColumnGen::activate(int p, int c, int i)
     if (!_activeVariables[p][c][2])
     {
       _activeVariables[p][c][2] = true;
-      _A[p][c][2].setUB(1);
+      _backend->setUpperBound(getIndex(p, c, 2), 1);
       ++_nrActiveVariables;
     }
   }
@@ -318,342 +357,189 @@ void ColumnGen::activate(int p, int c, int i)
     if (!_activeVariables[p][c][i + 1])
     {
       _activeVariables[p][c][i + 1] = true;
-      _A[p][c][i + 1].setUB(1);
+      _backend->setUpperBound(getIndex(p, c, i + 1), 1);
       ++_nrActiveVariables;
     }
   }
 }
 
-int ColumnGen::separate()
+void ColumnGen::identifyViolatedConstraints(int m,
+                                            int n,
+                                            int k,
+                                            const StlDoubleVector& vals,
+                                            ViolatedConstraintList& constraints,
+                                            Budget* budget)
 {
-  IloNumArray vals = IloNumArray(_env, _vars.getSize());
-  _cplex.getValues(vals, _vars);
-  
-  ViolatedConstraintList constraints;
+  switch (k)
+  {
+    case 0:
+      identifyViolatedConstraints<0>(m, n, k, vals, constraints, budget);
+      break;
+    case 1:
+      identifyViolatedConstraints<1>(m, n, k, vals, constraints, budget);
+      break;
+    case 2:
+      identifyViolatedConstraints<2>(m, n, k, vals, constraints, budget);
+      break;
+    case 3:
+      identifyViolatedConstraints<3>(m, n, k, vals, constraints, budget);
+      break;
+    case 4:
+      identifyViolatedConstraints<4>(m, n, k, vals, constraints, budget);
+      break;
+    default:
+      identifyViolatedConstraints<-1>(m, n, k, vals, constraints, budget);
+      break;
+  }
+}
+
+template<int K>
+void ColumnGen::identifyViolatedConstraints(int m,
+                                            int n,
+                                            int k,
+                                            const StlDoubleVector& vals,
+                                            ViolatedConstraintList& constraints,
+                                            Budget* budget)
+{
+  const StateIndex<K> index(n, k);
   
-  std::set<IntPair> activationSet;
-  typedef std::set<int> IntSet;
+  // values read since the budget was last charged
+  double ticks = 0;
   
-  for (int c = 0; c < _n; ++c)
+  // taxa with nonzero values for state s_c in character c and s_d in d
+  auto collect = [&](int c, int s_c, int d, int s_d, StlIntVector& rows)
   {
-    for (int d = c + 1; d < _n; ++d)
+    ticks += 2 * m;
+    rows.clear();
+    for (int p = 0; p < m; ++p)
     {
-      // condition 1
-      for (int i = 1; i <= _k + 1; ++i)
-      {
-        for (int i_prime = 1; i_prime <= _k + 1; ++i_prime)
-        {
-          for (int j = 1; j <= _k + 1; ++j)
-          {
-            for (int j_prime = 1; j_prime <= _k + 1; ++j_prime)
-            {
-              IntSet pSet;
-              for (int p = 0; p < _m; p++)
-              {
-                if (g_tol.nonZero(vals[getIndex(p, c, i)]) && g_tol.nonZero(vals[getIndex(p, d, 0)]))
-                {
-                  pSet.insert(p);
-                }
-              }
-              
-              IntSet qSet;
-              for (int q = 0; q < _m; q++)
-              {
-                if (g_tol.nonZero(vals[getIndex(q, c, 0)]) && g_tol.nonZero(vals[getIndex(q, d, j)]))
-                {
-                  qSet.insert(q);
-                }
-              }
-              
-              IntSet rSet;
-              for (int r = 0; r < _m; r++)
-              {
-                if (g_tol.nonZero(vals[getIndex(r, c, i_prime)]) && g_tol.nonZero(vals[getIndex(r, d, j_prime)]))
-                {
-                  rSet.insert(r);
-                }
-              }
-              
-              for (int p : pSet)
-              {
-                for (int q : qSet)
-                {
-                  for (int r : rSet)
-                  {
-                    activate(p, c, i);
-                    activate(p, d, 0);
-                    activate(q, c, 0);
-                    activate(q, d, j);
-                    activate(r, c, i_prime);
-                    activate(r, d, j_prime);
-                    
-                    ViolatedConstraint constraint;
-                    constraint[0] = Triple(p, c, i);
-                    constraint[1] = Triple(p, d, 0);
-                    constraint[2] = Triple(q, c, 0);
-                    constraint[3] = Triple(q, d, j);
-                    constraint[4] = Triple(r, c, i_prime);
-                    constraint[5] = Triple(r, d, j_prime);
-                    constraints.push_back(constraint);
-                  }
-                }
-              }
-            }
-          }
-        }
-      }
-      
-      // condition 2
-      for (int i = 1; i <= _k + 1; ++i)
-      {
-        for (int i_prime = 1; i_prime <= _k + 1; ++i_prime)
-        {
-          for (int j = 2; j <= _k + 1; ++j)
-          {
-            for (int j_prime = 1; j_prime <= _k + 1; ++j_prime)
-            {
-              if (j_prime == j) continue;
-          
-              IntSet pSet;
-              for (int p = 0; p < _m; p++)
-              {
-                if (g_tol.nonZero(vals[getIndex(p, c, i)]) && g_tol.nonZero(vals[getIndex(p, d, j_prime)]))
-                {
-                  pSet.insert(p);
-                }
-              }
-              
-              IntSet qSet;
-              for (int q = 0; q < _m; q++)
-              {
-                if (g_tol.nonZero(vals[getIndex(q, c, 0)]) && g_tol.nonZero(vals[getIndex(q, d, j)]))
-                {
-                  qSet.insert(q);
-                }
-              }
-              
-              IntSet rSet;
-              for (int r = 0; r < _m; r++)
-              {
-                if (g_tol.nonZero(vals[getIndex(r, c, i_prime)]) && g_tol.nonZero(vals[getIndex(r, d, j)]))
-                {
-                  rSet.insert(r);
-                }
-              }
-              
-              for (int p : pSet)
-              {
-                for (int q : qSet)
-                {
-                  for (int r : rSet)
-                  {
-                    activate(p, c, i);
-                    activate(p, d, j_prime);
-                    activate(q, c, 0);
-                    activate(q, d, j);
-                    activate(r, c, i_prime);
-                    activate(r, d, j);
-                    
-                    ViolatedConstraint constraint;
-                    constraint[0] = Triple(p, c, i);
-                    constraint[1] = Triple(p, d, j_prime);
-                    constraint[2] = Triple(q, c, 0);
-                    constraint[3] = Triple(q, d, j);
-                    constraint[4] = Triple(r, c, i_prime);
-                    constraint[5] = Triple(r, d, j);
-                    constraints.push_back(constraint);
-                  }
-                }
-              }
-            }
-          }
-        }
-      }
-      
-      // condition 3
-      for (int i = 2; i <= _k + 1; ++i)
+      if (g_tol.nonZero(vals[index(p, c, s_c)]) && g_tol.nonZero(vals[index(p, d, s_d)]))
       {
-        for (int i_prime = 1; i_prime <= _k + 1; ++i_prime)
-        {
-          if (i_prime == i) continue;
-          for (int j = 1; j <= _k + 1; ++j)
-          {
-            for (int j_prime = 1; j_prime <= _k + 1; ++j_prime)
-            {
-              IntSet pSet;
-              for (int p = 0; p < _m; p++)
-              {
-                if (g_tol.nonZero(vals[getIndex(p, c, i)]) && g_tol.nonZero(vals[getIndex(p, d, 0)]))
-                {
-                  pSet.insert(p);
-                }
-              }
-              
-              IntSet qSet;
-              for (int q = 0; q < _m; q++)
-              {
-                if (g_tol.nonZero(vals[getIndex(q, c, i_prime)]) && g_tol.nonZero(vals[getIndex(q, d, j)]))
-                {
-                  qSet.insert(q);
-                }
-              }
-              
-              IntSet rSet;
-              for (int r = 0; r < _m; r++)
-              {
-                if (g_tol.nonZero(vals[getIndex(r, c, i)]) && g_tol.nonZero(vals[getIndex(r, d, j_prime)]))
-                {
-                  rSet.insert(r);
-                }
-              }
-              
-              for (int p : pSet)
-              {
-                for (int q : qSet)
-                {
-                  for (int r : rSet)
-                  {
-                    activate(p, c, i);
-                    activate(p, d, 0);
-                    activate(q, c, i_prime);
-                    activate(q, d, j);
-                    activate(r, c, i);
-                    activate(r, d, j_prime);
-                    
-                    ViolatedConstraint constraint;
-                    constraint[0] = Triple(p, c, i);
-                    constraint[1] = Triple(p, d, 0);
-                    constraint[2] = Triple(q, c, i_prime);
-                    constraint[3] = Triple(q, d, j);
-                    constraint[4] = Triple(r, c, i);
-                    constraint[5] = Triple(r, d, j_prime);
-                    constraints.push_back(constraint);
-                  }
-                }
-              }
-            }
-          }
-        }
+        rows.push_back(p);
       }
-      
-      // condition 4
-      for (int i = 2; i <= _k + 1; ++i)
+    }
+  };
+  
+  // charge the values read for the previous character pair, stop once the
+  // budget is exceeded
+  auto tickPair = [&](int, int)
+  {
+    bool res = !budget || budget->tick(ticks);
+    ticks = 0;
+    return res;
+  };
+  
+  StlIntVector P, Q, R;
+  forEachForbiddenPattern<K>(k, n, tickPair, [&](int c, int d, const ForbiddenPattern& pattern)
+  {
+    collect(c, pattern._pc, d, pattern._pd, P);
+    if (P.empty()) return true;
+    collect(c, pattern._qc, d, pattern._qd, Q);
+    if (Q.empty()) return true;
+    collect(c, pattern._rc, d, pattern._rd, R);
+    
+    for (int p : P)
+    {
+      for (int q : Q)
       {
-        for (int i_prime = 1; i_prime <= _k + 1; ++i_prime)
+        for (int r : R)
         {
-          if (i_prime == i) continue;
-          for (int j = 2; j <= _k + 1; ++j)
-          {
-            for (int j_prime = 1; j_prime <= _k + 1; ++j_prime)
-            {
-              if (j_prime == j) continue;
-              
-              IntSet pSet;
-              for (int p = 0; p < _m; p++)
-              {
-                if (g_tol.nonZero(vals[getIndex(p, c, i)]) && g_tol.nonZero(vals[getIndex(p, d, j_prime)]))
-                {
-                  pSet.insert(p);
-                }
-              }
-              
-              IntSet qSet;
-              for (int q = 0; q < _m; q++)
-              {
-                if (g_tol.nonZero(vals[getIndex(q, c, i_prime)]) && g_tol.nonZero(vals[getIndex(q, d, j)]))
-                {
-                  qSet.insert(q);
-                }
-              }
-              
-              IntSet rSet;
-              for (int r = 0; r < _m; r++)
-              {
-                if (g_tol.nonZero(vals[getIndex(r, c, i)]) && g_tol.nonZero(vals[getIndex(r, d, j)]))
-                {
-                  rSet.insert(r);
-                }
-              }
-              
-              for (int p : pSet)
-              {
-                for (int q : qSet)
-                {
-                  for (int r : rSet)
-                  {
-                    activate(p, c, i);
-                    activate(p, d, j_prime);
-                    activate(q, c, i_prime);
-                    activate(q, d, j);
-                    activate(r, c, i);
-                    activate(r, d, j);
-                    
-                    ViolatedConstraint constraint;
-                    constraint[0] = Triple(p, c, i);
-                    constraint[1] = Triple(p, d, j_prime);
-                    constraint[2] = Triple(q, c, i_prime);
-                    constraint[3] = Triple(q, d, j);
-                    constraint[4] = Triple(r, c, i);
-                    constraint[5] = Triple(r, d, j);
-                    constraints.push_back(constraint);
-                  }
-                }
-              }
-            }
-          }
+          ViolatedConstraint constraint;
+          constraint[0] = Triple(p, c, pattern._pc);
+          constraint[1] = Triple(p, d, pattern._pd);
+          constraint[2] = Triple(q, c, pattern._qc);
+          constraint[3] = Triple(q, d, pattern._qd);
+          constraint[4] = Triple(r, c, pattern._rc);
+          constraint[5] = Triple(r, d, pattern._rd);
+          constraints.push_back(constraint);
         }
       }
     }
+    return true;
+  });
+  if (budget)
+  {
+    budget->tick(ticks);
   }
+}
+
+int ColumnGen::separate()
+{
+  StlDoubleVector vals;
+  _backend->getValues(vals);
+  
+  ViolatedConstraintList constraints;
+  identifyViolatedConstraints(_m, _n, _k, vals, constraints, _budget);
   
-  IloConstraintArray modelConstraints(_env);
-  IloConstraintArray lazyConstraints(_env);
-  IloExpr sum(_env);
+  return addViolatedConstraints(constraints);
+}
+
+int ColumnGen::addViolatedConstraints(const ViolatedConstraintList& constraints)
+{
   for (const ViolatedConstraint& violatedConstraint : constraints)
   {
     for (int idx = 0; idx < 6; ++idx)
     {
-      sum += _vars[getIndex(violatedConstraint[idx])];
+      const Triple& triple = violatedConstraint[idx];
+      activate(triple._p, triple._c, triple._i);
     }
-    if (!_lazy)
-    {
-      modelConstraints.add(sum <= 5);
-    }
-    else
+  }
+  
+  MipBackend::RowVector rows;
+  for (const ViolatedConstraint& violatedConstraint : constraints)
+  {
+    MipBackend::Row row;
+    for (int idx = 0; idx < 6; ++idx)
     {
-      lazyConstraints.add(sum <= 5);
+      row._vars.push_back(getIndex(violatedConstraint[idx]));
     }
-    sum.clear();
+    row._coefs.assign(6, 1.);
+    row._lb = -MipBackend::INF;
+    row._ub = 5;
+    rows.push_back(row);
   }
   
-  if (lazyConstraints.getSize() > 0)
+  if (_lazy)
   {
-//    std::cerr << "Added " << lazyConstraints.getSize() << " lazy constraints" << std::endl;
-    _cplex.addLazyConstraints(lazyConstraints);
-    _cplex.addUserCuts(lazyConstraints);
-    
-    return lazyConstraints.getSize();
+    _backend->addLazyRows(rows);
   }
-  if (modelConstraints.getSize() > 0)
+  else
   {
-//    std::cerr << "Added " << modelConstraints.getSize() << " model constraints" << std::endl;
-    _model.add(modelConstraints);
-    
-    return modelConstraints.getSize();
+    for (const MipBackend::Row& row : rows)
+    {
+      _backend->addRow(row);
+    }
   }
+  if (_recordConstraints)
+  {
+    _separatedConstraints.insert(_separatedConstraints.end(),
+                                 constraints.begin(), constraints.end());
+  }
+  
+  return rows.size();
+}
+
+void ColumnGen::importConstraints(const ColumnGen& solver)
+{
+  assert(solver._m == _m && solver._n == _n && solver._k <= _k);
+  assert(solver._recordConstraints);
   
-  return 0;
+  // variable indices depend on k, constraints are stored as (p,c,i) triples
+  addViolatedConstraints(solver._separatedConstraints);
 }
 
 void ColumnGen::processSolution()
 {
+  StlDoubleVector vals;
+  _backend->getValues(vals);
+  
   for (int p = 0; p < _m; p++)
   {
     for (int c = 0; c < _n; ++c)
     {
       for (int i = 0; i <= _k + 1; ++i)
       {
-        bool a_pci = g_tol.nonZero(_cplex.getValue(_A[p][c][i]));
+        bool a_pci = g_tol.nonZero(vals[getIndex(p, c, i)]);
         if (a_pci)
         {
           _solA.setEntry(p, c, i);
@@ -668,52 +554,32 @@ bool ColumnGen::solve(int timeLimit,
                       int nrThreads,
                       bool verbose)
 {
-  if (!verbose)
-  {
-    _env.setOut(_env.getNullStream());
-    _env.setError(_env.getNullStream());
-    _env.setWarning(_env.getNullStream());
-    _cplex.setOut(_env.getNullStream());
-    _cplex.setError(_env.getNullStream());
-    _cplex.setWarning(_env.getNullStream());
-  }
-  else
-  {
-    _env.setOut(std::cerr);
-    _env.setError(std::cerr);
-    _env.setWarning(std::cerr);
-    _cplex.setOut(std::cerr);
-    _cplex.setError(std::cerr);
-    _cplex.setWarning(std::cerr);
-  }
-  
-//  _cplex.setParam(IloCplex::MIPEmphasis, IloCplex::MIPEmphasisFeasibility);
-  _cplex.setParam(IloCplex::ParallelMode, -1);
-  if (nrThreads > 0)
-  {
-    _cplex.setParam(IloCplex::Threads, nrThreads);
-  }
+  int t = -1;
   if (timeLimit > 0)
   {
-    int t = timeLimit - g_timer.realTime();
-    if (t < 0)
+    t = timeLimit - g_timer.realTime();
+    if (t <= 0)
       return false;
-    _cplex.setParam(IloCplex::TiLim, t);
   }
-  if (memoryLimit > 0)
+  if (_budget)
   {
-    _cplex.setParam(IloCplex::WorkMem, memoryLimit);
+    double remaining = _budget->getRemainingTime(nrThreads);
+    if (remaining >= 0)
+    {
+      t = t < 0 ? ceil(remaining) : std::min<int>(t, ceil(remaining));
+      if (t <= 0)
+        return false;
+    }
   }
+  _backend->setParameters(t, memoryLimit, nrThreads, verbose);
+  _backend->setProfile(_profile);
   
-//  const int m = _B.getNrTaxa();
-//  IloFastMutex mutex;
-//  _cplex.use(IloCplex::Callback(new (_env) DolloCallback<IloCplex::UserCutCallbackI>(_env, _A, m, _n, _k, &mutex)));
-//  _cplex.use(IloCplex::Callback(new (_env) DolloCallback<IloCplex::LazyConstraintCallbackI>(_env, _A, m, _n, _k, &mutex)));
-  
-  _nrConstraints = _cplex.getNrows();
+  _nrConstraints = _backend->getNrRows();
   
   int iteration = 1;
   bool res = false;
+  double cplexTime = 0;
+  double separationTime = 0;
   while (true)
   {
     std::cerr << "Step " << iteration << " -- elapsed time " << g_timer.realTime() << " s" << std::endl;
@@ -725,17 +591,52 @@ bool ColumnGen::solve(int timeLimit,
       std::cerr << "Time limit exceeded" << std::endl;
       return false;
     }
+    if (_aborted)
+    {
+      std::cerr << "Aborted" << std::endl;
+      return false;
+    }
+    if (_budget && _budget->exceeded())
+    {
+      std::cerr << Budget::toString(_budget->check()) << std::endl;
+      return false;
+    }
+    
+    Matrix hotStart;
+    if (_hotStartProvider && _hotStartProvider(hotStart))
+    {
+      initHotStart(hotStart);
+    }
+    
+    if (_budget)
+    {
+      _backend->setDeterministicTimeLimit(_budget->getRemainingSolverTicks());
+    }
     
-    _cplex.solve();
-    if (_cplex.getStatus() != IloAlgorithm::Optimal || _cplex.getCplexStatus() == IloCplex::AbortTimeLim)
+    double startTime = g_timer.realTime();
+    bool optimal = _backend->solve();
+    cplexTime += g_timer.realTime() - startTime;
+    if (_budget)
+    {
+      _budget->tickSolver(_backend->getDeterministicTime());
+    }
+    if (!optimal)
     {
       res = false;
       break;
     }
     
+    startTime = g_timer.realTime();
     int separatedConstraints = separate();
+    separationTime += g_timer.realTime() - startTime;
     _nrConstraints += separatedConstraints;
     std::cerr << "Step " << iteration << " -- introduced " << separatedConstraints << " constraints" << std::endl;
+    if (_budget && _budget->exceeded())
+    {
+      // separation may have stopped early, the solution is not proven feasible
+      res = false;
+      break;
+    }
     if (separatedConstraints == 0)
     {
       res = true;
@@ -748,8 +649,10 @@ bool ColumnGen::solve(int timeLimit,
   if (res)
   {
     processSolution();
-    std::cerr << "CPLEX: [" << _cplex.getObjValue() << " , " << _cplex.getBestObjValue() << "]" << std::endl;
+    std::cerr << "CPLEX: [" << _backend->getObjValue() << " , " << _backend->getBestObjValue() << "]" << std::endl;
   }
+  std::cerr << "CPLEX time: " << cplexTime << std::endl;
+  std::cerr << "Separation time: " << separationTime << std::endl;
   std::cerr << "Elapsed time: " << g_timer.realTime() << std::endl;
   
   
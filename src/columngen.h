@@ -8,8 +8,14 @@
 #ifndef COLUMNGEN_H
 #define COLUMNGEN_H
 
-#include <ilcplex/ilocplex.h>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <array>
+#include <list>
 #include "matrix.h"
+#include "mipbackend.h"
+#include "budget.h"
 
 /// This class provides a column generation approach for the k-DP problem
 class ColumnGen
@@ -24,6 +30,30 @@ public:
             int k,
             bool lazy);
   
+  /// Set MIP backend, must be called before init()
+  ///
+  /// @param backend Backend name
+  void setBackend(const std::string& backend)
+  {
+    _backendName = backend;
+  }
+  
+  /// Set solver profile
+  ///
+  /// @param profile Solver profile
+  void setProfile(const SolverProfile& profile)
+  {
+    _profile = profile;
+  }
+  
+  /// Set resource budget, checked in addition to the time limit of solve()
+  ///
+  /// @param budget Budget, may be NULL
+  void setBudget(Budget* budget)
+  {
+    _budget = budget;
+  }
+  
   /// Initialize solver
   virtual void init();
   
@@ -33,6 +63,62 @@ public:
     return _solA;
   }
   
+  /// Add MIP start and activate its variables
+  ///
+  /// @param A k-Dollo completion
+  void initHotStart(const Matrix& A);
+  
+  /// Set whether separated constraints are recorded for importConstraints(),
+  /// disabled by default
+  ///
+  /// @param recordConstraints Record separated constraints
+  void setRecordConstraints(bool recordConstraints)
+  {
+    _recordConstraints = recordConstraints;
+  }
+  
+  /// Add the constraints separated by another solver for the same matrix
+  /// with at most as many losses per character, must be called after init().
+  /// Forbidden submatrices for k losses are also forbidden for k + 1 losses.
+  /// The other solver must record its separated constraints.
+  ///
+  /// @param solver Solver
+  void importConstraints(const ColumnGen& solver);
+  
+  /// Return objective value of the last solve
+  double getObjValue() const
+  {
+    return _backend->getObjValue();
+  }
+  
+  /// Return maximum number of losses per character
+  int getMaxNrLosses() const
+  {
+    return _k;
+  }
+  
+  /// Abort solve, may be called from another thread
+  void abort()
+  {
+    _aborted = true;
+    if (_backend)
+    {
+      _backend->abort();
+    }
+  }
+  
+  /// Function that is called before every iteration and returns true
+  /// if it provides a new hot start
+  typedef std::function<bool(Matrix&)> HotStartProvider;
+  
+  /// Set function providing hot starts during solve
+  ///
+  /// @param provider Hot start provider
+  void setHotStartProvider(const HotStartProvider& provider)
+  {
+    _hotStartProvider = provider;
+  }
+  
   /// Solve
   ///
   /// @param timeLimit Time limit in seconds
@@ -79,6 +165,14 @@ protected:
   /// Update variable bounds
   void updateVariableBounds();
   
+  /// Fix variable to the given value
+  ///
+  /// @param p Taxon
+  /// @param c Character
+  /// @param i State
+  /// @param value Value
+  void fixVariable(int p, int c, int i, int value);
+  
   /// Activate variable
   ///
   /// @param p Taxon
@@ -92,9 +186,6 @@ protected:
   /// Identify violated constraints
   int separate();
   
-  typedef IloArray<IloBoolVarArray> IloBoolVarMatrix;
-  typedef IloArray<IloBoolVarMatrix> IloBoolVar3Matrix;
-  
   typedef std::vector<StlBoolVector> StlBoolMatrix;
   typedef std::vector<StlBoolMatrix> StlBool3Matrix;
   
@@ -105,7 +196,19 @@ protected:
   /// @param i State
   int getIndex(int p, int c, int i) const
   {
-    return (_n * (_k + 2)) * p + (_k + 2) * c + i;
+    return getIndex(_n, _k, p, c, i);
+  }
+  
+  /// Construct 1D index from (p,c,i) triple
+  ///
+  /// @param n Number of characters
+  /// @param k Maximum number of losses per character
+  /// @param p Taxon
+  /// @param c Character
+  /// @param i State
+  static int getIndex(int n, int k, int p, int c, int i)
+  {
+    return (n * (k + 2)) * p + (k + 2) * c + i;
   }
   
   /// Triple (p,c,i)
@@ -150,6 +253,45 @@ protected:
   /// List of forbidden submatrices
   typedef std::list<ViolatedConstraint> ViolatedConstraintList;
   
+  /// Activate the variables of the given forbidden submatrices and add the
+  /// corresponding constraints, returns the number of added constraints
+  ///
+  /// @param constraints Forbidden submatrices
+  int addViolatedConstraints(const ViolatedConstraintList& constraints);
+  
+  /// Identify forbidden submatrices in the given (fractional) solution
+  ///
+  /// @param m Number of taxa
+  /// @param n Number of characters
+  /// @param k Maximum number of losses per character
+  /// @param vals Solution values indexed by getIndex(n, k, p, c, i)
+  /// @param constraints Output list of forbidden submatrices
+  /// @param budget Budget charged one tick per solution value read, the
+  /// search stops early once it is exceeded
+  static void identifyViolatedConstraints(int m,
+                                          int n,
+                                          int k,
+                                          const StlDoubleVector& vals,
+                                          ViolatedConstraintList& constraints,
+                                          Budget* budget = NULL);
+  
+  /// Identify forbidden submatrices in the given (fractional) solution, for
+  /// K losses known at compile time or K = -1 for the generic case
+  ///
+  /// @param m Number of taxa
+  /// @param n Number of characters
+  /// @param k Maximum number of losses per character
+  /// @param vals Solution values indexed by getIndex(n, k, p, c, i)
+  /// @param constraints Output list of forbidden submatrices
+  /// @param budget Budget charged one tick per solution value read
+  template<int K>
+  static void identifyViolatedConstraints(int m,
+                                          int n,
+                                          int k,
+                                          const StlDoubleVector& vals,
+                                          ViolatedConstraintList& constraints,
+                                          Budget* budget);
+  
 protected:
   /// Input matrix
   const Matrix& _B;
@@ -161,24 +303,28 @@ protected:
   const int _k;
   /// Lazy constraints
   const bool _lazy;
-  /// Cplex environment
-  IloEnv _env;
-  /// Cplex model
-  IloModel _model;
-  /// Cplex solver
-  IloCplex _cplex;
-  /// _A[p][c][i] is the multi-state matrix
-  IloBoolVar3Matrix _A;
-  /// Flatten variable matrix _A
-  IloBoolVarArray _vars;
-  /// Objective function
-  IloExpr _obj;
+  /// MIP backend name
+  std::string _backendName;
+  /// Solver profile
+  SolverProfile _profile;
+  /// Resource budget, may be NULL
+  Budget* _budget;
+  /// MIP backend, variable getIndex(p,c,i) indicates whether entry (p,c) has state i
+  std::unique_ptr<MipBackend> _backend;
+  /// Indicates whether solve has been aborted
+  std::atomic<bool> _aborted;
+  /// Hot start provider
+  HotStartProvider _hotStartProvider;
   /// Indicates which variables are active
   StlBool3Matrix _activeVariables;
   /// Number of active variables
   int _nrActiveVariables;
   /// Number of constraints
   int _nrConstraints;
+  /// Indicates whether separated constraints are recorded
+  bool _recordConstraints;
+  /// Forbidden submatrices separated so far, if recorded
+  ViolatedConstraintList _separatedConstraints;
   /// Solution matrix
   Matrix _solA;
 };
@@ -6,7 +6,6 @@
  */
 
 #include "columngenflip.h"
-#include <ilconcert/ilothread.h>
 #include <lemon/time_measure.h>
 
 ColumnGenFlip::ColumnGenFlip(const Matrix& B,
@@ -33,6 +32,48 @@ ColumnGenFlip::ColumnGenFlip(const Matrix& B,
 {
 }
 
+void ColumnGenFlip::setErrorRates(double alpha, double beta)
+{
+  _alpha = alpha;
+  _beta = beta;
+  initObjective();
+}
+
+double ColumnGenFlip::getLogLikelihood(const Matrix& B,
+                                       const Matrix& A,
+                                       double alpha,
+                                       double beta)
+{
+  assert(B.getNrTaxa() == A.getNrTaxa());
+  assert(B.getNrCharacters() == A.getNrCharacters());
+  
+  // same coefficients as initObjective
+  const double log_alpha = log(alpha);
+  const double log_1_minus_alpha = log(1 - alpha);
+  const double log_beta = log(beta);
+  const double log_1_minus_beta = log(1 - beta);
+  
+  double res = 0;
+  for (int p = 0; p < B.getNrTaxa(); ++p)
+  {
+    for (int c = 0; c < B.getNrCharacters(); ++c)
+    {
+      int b_pc = B.getEntry(p, c);
+      int a_pc = A.getEntry(p, c);
+      if (b_pc == 0)
+      {
+        res += a_pc == 1 ? log_beta : log_1_minus_alpha;
+      }
+      else if (b_pc == 1)
+      {
+        res += a_pc == 1 ? log_1_minus_beta : log_alpha;
+      }
+    }
+  }
+  
+  return res;
+}
+
 void ColumnGenFlip::initFixedEntriesConstraints()
 {
 }
@@ -44,8 +85,7 @@ void ColumnGenFlip::initObjective()
   const double log_beta = log(_beta);
   const double log_1_minus_beta = log(1 - _beta);
   
-  IloExpr x(_env);
-  IloExpr y(_env);
+  StlDoubleVector obj(_backend->getNrVariables(), 0.);
   for (int p = 0; p < _m; p++)
   {
     for (int c = 0; c < _n; c++)
@@ -57,15 +97,15 @@ void ColumnGenFlip::initObjective()
         {
           if (j == 0)
           {
-            _obj += log_1_minus_alpha * _A[p][c][j];
+            obj[getIndex(p, c, j)] += log_1_minus_alpha;
           }
           else if (j == 1)
           {
-            _obj += log_beta * _A[p][c][j];
+            obj[getIndex(p, c, j)] += log_beta;
           }
           else
           {
-            _obj += log_1_minus_alpha * _A[p][c][j];
+            obj[getIndex(p, c, j)] += log_1_minus_alpha;
           }
         }
       }
@@ -75,22 +115,21 @@ void ColumnGenFlip::initObjective()
         {
           if (j == 0)
           {
-            _obj += log_alpha * _A[p][c][j];
+            obj[getIndex(p, c, j)] += log_alpha;
           }
           else if (j == 1)
           {
-            _obj += log_1_minus_beta * _A[p][c][j];
+            obj[getIndex(p, c, j)] += log_1_minus_beta;
           }
           else
           {
-            _obj += log_alpha * _A[p][c][j];
+            obj[getIndex(p, c, j)] += log_alpha;
           }
         }
       }
     }
   }
   
-  IloExpr lossSum(_env);
   double unit = std::max(log_alpha, std::max(log_beta, std::max(log_1_minus_alpha, log_1_minus_beta)));
   for (int p = 0; p < _m; ++p)
   {
@@ -98,14 +137,16 @@ void ColumnGenFlip::initObjective()
     {
       for (int i = 2; i <= _k + 1; ++i)
       {
-        lossSum += _A[p][c][i] * pow(1./(_m * _n), _k + 2 - i);// (unit / (m * _n));
+        obj[getIndex(p, c, i)] += unit * pow(1./(_m * _n), _k + 2 - i);// (unit / (m * _n));
       }
     }
   }
   
-  _obj += lossSum * unit;
-  _obj = 1000 * _obj;
-  _model.add(IloMaximize(_env, _obj));
+  for (double& coef : obj)
+  {
+    coef *= 1000;
+  }
+  _backend->setObjective(obj, 0, true);
 }
 
 void ColumnGenFlip::activate(int p, int c, int i)
@@ -115,7 +156,7 @@ void ColumnGenFlip::activate(int p, int c, int i)
     if (!_activeVariables[p][c][1])
     {
       _activeVariables[p][c][1] = true;
-      _A[p][c][1].setUB(1);
+      _backend->setUpperBound(getIndex(p, c, 1), 1);
       ++_nrActiveVariables;
     }
     for (int j = 2; j <= _k + 1; ++j)
@@ -123,7 +164,7 @@ void ColumnGenFlip::activate(int p, int c, int i)
       if (_k >= 1 && !_activeVariables[p][c][j])
       {
         _activeVariables[p][c][j] = true;
-        _A[p][c][j].setUB(1);
+        _backend->setUpperBound(getIndex(p, c, j), 1);
         ++_nrActiveVariables;
       }
     }
@@ -133,7 +174,7 @@ void ColumnGenFlip::activate(int p, int c, int i)
     if (!_activeVariables[p][c][0])
     {
       _activeVariables[p][c][0] = true;
-      _A[p][c][0].setUB(1);
+      _backend->setUpperBound(getIndex(p, c, 0), 1);
       ++_nrActiveVariables;
     }
     for (int j = 2; j <= _k + 1; ++j)
@@ -141,7 +182,7 @@ void ColumnGenFlip::activate(int p, int c, int i)
       if (!_activeVariables[p][c][j])
       {
         _activeVariables[p][c][j] = true;
-        _A[p][c][j].setUB(1);
+        _backend->setUpperBound(getIndex(p, c, j), 1);
         ++_nrActiveVariables;
       }
     }
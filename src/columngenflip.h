@@ -8,7 +8,6 @@
 #ifndef COLUMNGENFLIP_H
 #define COLUMNGENFLIP_H
 
-#include <ilcplex/ilocplex.h>
 #include "matrix.h"
 #include "columngen.h"
 
@@ -29,6 +28,27 @@ public:
                 double alpha,
                 double beta);
   
+  /// Change the error rates of an initialized model. Only the objective
+  /// function is updated, separated constraints and active variables are kept.
+  ///
+  /// @param alpha False positive rate
+  /// @param beta False negative rate
+  void setErrorRates(double alpha, double beta);
+  
+  /// Return log Pr(B | A, alpha, beta) under the error model of the
+  /// objective function, where an entry with state 1 in A is observed as 0
+  /// with probability beta and any other state is observed as 1 with
+  /// probability alpha. Missing entries of B are skipped.
+  ///
+  /// @param B Input matrix
+  /// @param A Completion
+  /// @param alpha False positive rate
+  /// @param beta False negative rate
+  static double getLogLikelihood(const Matrix& B,
+                                 const Matrix& A,
+                                 double alpha,
+                                 double beta);
+  
 protected:
   /// Hidden constructor where output matrix dimensions may differ from input matrix
   ///
@@ -62,9 +82,9 @@ protected:
   
 protected:
   /// False positive rate
-  const double _alpha;
+  double _alpha;
   /// False negative rate
-  const double _beta;
+  double _beta;
 };
 
 #endif // COLUMNGENFLIP_H
@@ -109,35 +109,6 @@ void ColumnGenFlipClustered::initActiveVariables()
   updateVariableBounds();
 }
 
-void ColumnGenFlipClustered::initHotStart(const Matrix& E)
-{
-  IloNumVarArray startVar(_env);
-  IloNumArray startVal(_env);
-  
-  for (int h = 0; h < _s; ++h)
-  {
-    for (int f = 0; f < _t; ++f)
-    {
-      for (int i = 0; i <= _k + 1; ++i)
-      {
-        startVar.add(_A[h][f][i]);
-        startVal.add(i == E.getEntry(h, f) ? 1 : 0);
-        
-        if (E.getEntry(h, f) == i && !_activeVariables[h][f][i])
-        {
-          _activeVariables[h][f][i] = true;
-          _A[h][f][i].setUB(1);
-          ++_nrActiveVariables;
-        }
-      }
-    }
-  }
-  
-  _cplex.addMIPStart(startVar, startVal);
-  startVar.end();
-  startVal.end();
-}
-
 void ColumnGenFlipClustered::initObjective()
 {
   const int m = _B.getNrTaxa();
@@ -148,6 +119,7 @@ void ColumnGenFlipClustered::initObjective()
   const double log_beta = log(_beta);
   const double log_1_minus_beta = log(1 - _beta);
   
+  StlDoubleVector obj(_backend->getNrVariables(), 0.);
   for (int c = 0; c < n; ++c)
   {
     const int f = _zC[c];
@@ -165,15 +137,15 @@ void ColumnGenFlipClustered::initObjective()
         {
           if (j == 0)
           {
-            _obj += mult * log_1_minus_beta * _A[h][f][j];
+            obj[getIndex(h, f, j)] += mult * log_1_minus_beta;
           }
           else if (j == 1)
           {
-            _obj += mult * log_beta * _A[h][f][j];
+            obj[getIndex(h, f, j)] += mult * log_beta;
           }
           else
           {
-            _obj += mult * log_1_minus_beta * _A[h][f][j];
+            obj[getIndex(h, f, j)] += mult * log_1_minus_beta;
           }
         }
       }
@@ -183,15 +155,15 @@ void ColumnGenFlipClustered::initObjective()
         {
           if (j == 0)
           {
-            _obj += mult * log_alpha * _A[h][f][j];
+            obj[getIndex(h, f, j)] += mult * log_alpha;
           }
           else if (j == 1)
           {
-            _obj += mult * log_1_minus_alpha * _A[h][f][j];
+            obj[getIndex(h, f, j)] += mult * log_1_minus_alpha;
           }
           else
           {
-            _obj += mult * log_alpha * _A[h][f][j];
+            obj[getIndex(h, f, j)] += mult * log_alpha;
           }
         }
       }
@@ -199,7 +171,6 @@ void ColumnGenFlipClustered::initObjective()
   }
   
   // TODO: minimize losses?
-  IloExpr lossSum(_env);
   double unit = 0;
   unit = std::max(log_alpha, std::max(log_beta, std::max(log_1_minus_alpha, log_1_minus_beta)));
   
@@ -209,13 +180,14 @@ void ColumnGenFlipClustered::initObjective()
     {
       for (int i = 2; i <= _k + 1; ++i)
       {
-        lossSum += _A[h][f][i] * pow(1./(_s * _t), _k + 2 - i);
+        obj[getIndex(h, f, i)] += unit * pow(1./(_s * _t), _k + 2 - i);
       }
     }
   }
   
-  _obj += _baseL;
-  _obj += lossSum * unit;
-  _obj *= 1000;
-  _model.add(IloMaximize(_env, _obj));
+  for (double& coef : obj)
+  {
+    coef *= 1000;
+  }
+  _backend->setObjective(obj, 1000 * _baseL, true);
 }
@@ -39,8 +39,6 @@ public:
                          int s,
                          const StlIntVector& zT);
   
-  void initHotStart(const Matrix& E);
-  
 protected:
   /// Initialize objective function
   virtual void initObjective();
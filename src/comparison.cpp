@@ -7,21 +7,74 @@
 
 #include "comparison.h"
 #include "phylogenetictree.h"
+#include <thread>
+#include <unordered_set>
 
 Comparison::Comparison(const PhylogeneticTree& trueT,
-                       const PhylogeneticTree& inferredT)
+                       const PhylogeneticTree& inferredT,
+                       bool splitSets)
   : _trueT(trueT)
   , _inferredT(inferredT)
-  , _trueSplits()
-  , _inferredSplits()
-  , _symDiffSplits()
+  , _nrTrueSplits(0)
+  , _nrInferredSplits(0)
+  , _nrCommonSplits(0)
 {
-  _trueSplits = _trueT.getSplitSet();
-  _inferredSplits = _inferredT.getSplitSet();
+  if (splitSets)
+  {
+    countSplitsBySets();
+  }
+  else
+  {
+    countSplitsByIntervals();
+  }
+}
+
+void Comparison::countSplitsBySets()
+{
+  PhylogeneticTree::SplitSet trueSplits = _trueT.getSplitSet();
+  PhylogeneticTree::SplitSet inferredSplits = _inferredT.getSplitSet();
   
-  std::set_symmetric_difference(_trueSplits.begin(), _trueSplits.end(),
-                                _inferredSplits.begin(), _inferredSplits.end(),
-                                std::inserter(_symDiffSplits, _symDiffSplits.begin()));
+  _nrTrueSplits = trueSplits.size();
+  _nrInferredSplits = inferredSplits.size();
+  _nrCommonSplits = 0;
+  for (const PhylogeneticTree::Split& split : inferredSplits)
+  {
+    _nrCommonSplits += trueSplits.count(split);
+  }
+}
+
+void Comparison::countSplitsByIntervals()
+{
+  const StlIntVector order = _trueT.getLeafOrder();
+  const long long m = order.size();
+  StlIntVector position(m, -1);
+  for (int i = 0; i < m; ++i)
+  {
+    position[order[i]] = i;
+  }
+  
+  PhylogeneticTree::SplitIntervalVector trueIntervals, inferredIntervals;
+  _trueT.getSplitIntervals(position, trueIntervals);
+  _inferredT.getSplitIntervals(position, inferredIntervals);
+  
+  std::unordered_set<long long> trueSplits(2 * trueIntervals.size());
+  for (const PhylogeneticTree::SplitInterval& interval : trueIntervals)
+  {
+    assert(interval.isContiguous());
+    trueSplits.insert(interval._min * m + interval._max);
+  }
+  
+  _nrTrueSplits = trueIntervals.size();
+  _nrInferredSplits = inferredIntervals.size();
+  _nrCommonSplits = 0;
+  for (const PhylogeneticTree::SplitInterval& interval : inferredIntervals)
+  {
+    if (interval.isContiguous()
+        && trueSplits.count(interval._min * m + interval._max))
+    {
+      ++_nrCommonSplits;
+    }
+  }
 }
 
 void Comparison::computeFlips(const Matrix& input,
@@ -157,34 +210,112 @@ void Comparison::recallCharStatePairs(double& ancestralRecall,
                                       double& clusteredRecall,
                                       bool ignoreLoss) const
 {
-  PhylogeneticTree::TwoCharStatesSet trueAncestralSet, trueIncomparableSet, trueClusteredSet;
-  _trueT.computePairs(trueAncestralSet,
-                      trueIncomparableSet,
-                      trueClusteredSet,
-                      ignoreLoss);
+  PhylogeneticTree::TwoCharStatesVector trueAncestral, trueIncomparable, trueClustered;
+  std::thread trueThread([&]()
+  {
+    _trueT.computePairs(trueAncestral,
+                        trueIncomparable,
+                        trueClustered,
+                        ignoreLoss);
+  });
   
-  PhylogeneticTree::TwoCharStatesSet inferredAncestralSet, inferredIncomparableSet, inferredClusteredSet;
-  _inferredT.computePairs(inferredAncestralSet,
-                          inferredIncomparableSet,
-                          inferredClusteredSet,
+  PhylogeneticTree::TwoCharStatesVector inferredAncestral, inferredIncomparable, inferredClustered;
+  _inferredT.computePairs(inferredAncestral,
+                          inferredIncomparable,
+                          inferredClustered,
                           ignoreLoss);
+  trueThread.join();
+  
+  ancestralRecall = (double) countIntersection(trueAncestral, inferredAncestral) / (double) trueAncestral.size();
+  incomparableRecall = (double) countIntersection(trueIncomparable, inferredIncomparable) / (double) trueIncomparable.size();
+  clusteredRecall = (double) countIntersection(trueClustered, inferredClustered) / (double) trueClustered.size();
+}
+
+size_t Comparison::countIntersection(const PhylogeneticTree::TwoCharStatesVector& sortedA,
+                                     const PhylogeneticTree::TwoCharStatesVector& sortedB)
+{
+  size_t count = 0;
+  auto itA = sortedA.begin();
+  auto itB = sortedB.begin();
+  while (itA != sortedA.end() && itB != sortedB.end())
+  {
+    if (*itA < *itB)
+    {
+      ++itA;
+    }
+    else if (*itB < *itA)
+    {
+      ++itB;
+    }
+    else
+    {
+      ++count;
+      ++itA;
+      ++itB;
+    }
+  }
+  return count;
+}
+
+void Comparison::computeClusteringMetrics(const StlIntVector& trueClustering,
+                                          const StlIntVector& inferredClustering,
+                                          double& RI,
+                                          double& recall,
+                                          double& precision)
+{
+  assert(trueClustering.size() == inferredClustering.size());
+  const long long n = trueClustering.size();
+  
+  // contingency table: pairs (true cluster, inferred cluster), sorted so that
+  // equal cells, and cells of the same true cluster, are consecutive
+  IntPairVector contingency(n);
+  for (long long c = 0; c < n; ++c)
+  {
+    contingency[c] = IntPair(trueClustering[c], inferredClustering[c]);
+  }
+  std::sort(contingency.begin(), contingency.end());
   
-  PhylogeneticTree::TwoCharStatesSet commonAncestralSet, commonIncomparableSet, commonClusteredSet;
-  std::set_intersection(trueAncestralSet.begin(), trueAncestralSet.end(),
-                        inferredAncestralSet.begin(), inferredAncestralSet.end(),
-                        std::inserter(commonAncestralSet, commonAncestralSet.begin()));
+  auto choose2 = [](long long x) { return x * (x - 1) / 2; };
   
-  std::set_intersection(trueIncomparableSet.begin(), trueIncomparableSet.end(),
-                        inferredIncomparableSet.begin(), inferredIncomparableSet.end(),
-                        std::inserter(commonIncomparableSet, commonIncomparableSet.begin()));
+  // P: pairs in the same true cluster
+  // TP: pairs in the same true and inferred cluster
+  long long P = 0, TP = 0;
+  for (long long start = 0, cellStart = 0, idx = 1; idx <= n; ++idx)
+  {
+    if (idx == n || contingency[idx] != contingency[cellStart])
+    {
+      TP += choose2(idx - cellStart);
+      cellStart = idx;
+    }
+    if (idx == n || contingency[idx].first != contingency[start].first)
+    {
+      P += choose2(idx - start);
+      start = idx;
+    }
+  }
   
-  std::set_intersection(trueClusteredSet.begin(), trueClusteredSet.end(),
-                        inferredClusteredSet.begin(), inferredClusteredSet.end(),
-                        std::inserter(commonClusteredSet, commonClusteredSet.begin()));
+  // Q: pairs in the same inferred cluster
+  StlIntVector inferredSorted(inferredClustering);
+  std::sort(inferredSorted.begin(), inferredSorted.end());
+  long long Q = 0;
+  for (long long start = 0, idx = 1; idx <= n; ++idx)
+  {
+    if (idx == n || inferredSorted[idx] != inferredSorted[start])
+    {
+      Q += choose2(idx - start);
+      start = idx;
+    }
+  }
   
-  ancestralRecall = (double) commonAncestralSet.size() / (double) trueAncestralSet.size();
-  incomparableRecall = (double) commonIncomparableSet.size() / (double) trueIncomparableSet.size();
-  clusteredRecall = (double) commonClusteredSet.size() / (double) trueClusteredSet.size();
+  const long long total = choose2(n);
+  const long long N = total - P;
+  const long long TN = total - P - Q + TP;
+  
+  RI = TP + TN;
+  RI /= total;
+  
+  recall = TP / (double) P;
+  precision = TN / (double) N;
 }
 
 void Comparison::getCharactersClusteringMetrics(double& RI,
@@ -195,42 +326,14 @@ void Comparison::getCharactersClusteringMetrics(double& RI,
   Matrix inferredB = _inferredT.getMatrixB();
 
   assert(trueB.getNrCharacters() == inferredB.getNrCharacters());
-  const int n = inferredB.getNrCharacters();
   
   StlIntVector trueCharacterClustering, inferredCharacterClustering;
   trueB.identifyRepeatedColumns(trueCharacterClustering);
   inferredB.identifyRepeatedColumns(inferredCharacterClustering);
   
-  IntPairSet TP, TN;
-  IntPairSet P, N;
-  for (int c = 0; c < n; ++c)
-  {
-    for (int d = c + 1; d < n; ++d)
-    {
-      if (trueCharacterClustering[c] == trueCharacterClustering[d])
-      {
-        P.insert(IntPair(c, d));
-        if (inferredCharacterClustering[c] == inferredCharacterClustering[d])
-        {
-          TP.insert(IntPair(c, d));
-        }
-      }
-      else
-      {
-        N.insert(IntPair(c, d));
-        if (inferredCharacterClustering[c] != inferredCharacterClustering[d])
-        {
-          TN.insert(IntPair(c, d));
-        }
-      }
-    }
-  }
-    
-  RI = TP.size() + TN.size();
-  RI /= (n * (n - 1) / 2);
-
-  recall = TP.size() / (double) P.size();
-  precision = TN.size() / (double) N.size();
+  computeClusteringMetrics(trueCharacterClustering,
+                           inferredCharacterClustering,
+                           RI, recall, precision);
 }
 
 void Comparison::getTaxaClusteringMetrics(double& RI,
@@ -241,40 +344,12 @@ void Comparison::getTaxaClusteringMetrics(double& RI,
   Matrix inferredB = _inferredT.getMatrixB();
   
   assert(trueB.getNrCharacters() == inferredB.getNrCharacters());
-  const int m = trueB.getNrTaxa();
   
   StlIntVector trueTaxaClustering, inferredTaxaClustering;
   trueB.identifyRepeatedRows(trueTaxaClustering);
   inferredB.identifyRepeatedRows(inferredTaxaClustering);
   
-  IntPairSet TP, TN;
-  IntPairSet P, N;
-  for (int p = 0; p < m; ++p)
-  {
-    for (int q = p + 1; q < m; ++q)
-    {
-      if (trueTaxaClustering[p] == trueTaxaClustering[q])
-      {
-        P.insert(IntPair(p,q));
-        if (inferredTaxaClustering[p] == inferredTaxaClustering[q])
-        {
-          TP.insert(IntPair(p, q));
-        }
-      }
-      else
-      {
-        N.insert(IntPair(p, q));
-        if (inferredTaxaClustering[p] != inferredTaxaClustering[q])
-        {
-          TN.insert(IntPair(p, q));
-        }
-      }
-    }
-  }
-  
-  RI = TP.size() + TN.size();
-  RI /= (m * (m - 1) / 2);
-  
-  recall = TP.size() / (double) P.size();
-  precision = TN.size() / (double) N.size();
+  computeClusteringMetrics(trueTaxaClustering,
+                           inferredTaxaClustering,
+                           RI, recall, precision);
 }
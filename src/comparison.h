@@ -19,13 +19,15 @@ public:
   ///
   /// @param trueT True phylogenetic tree
   /// @param inferredT Inferred phylogenetic tree
+  /// @param splitSets Compare explicit split sets instead of split intervals
   Comparison(const PhylogeneticTree& trueT,
-             const PhylogeneticTree& inferredT);
+             const PhylogeneticTree& inferredT,
+             bool splitSets = false);
   
   /// Return Robinson-Foulds distance
   int getRF() const
   {
-    return _symDiffSplits.size();
+    return _nrTrueSplits + _nrInferredSplits - 2 * _nrCommonSplits;
   }
   
   /// Return log likelihood of inferred matrix
@@ -37,9 +39,7 @@ public:
   /// Return normalized Robinson-Foulds distance
   double getNormalizedRF() const
   {
-    PhylogeneticTree::SplitSet combined = _trueSplits;
-    combined.insert(_inferredSplits.begin(), _inferredSplits.end());
-    return (double) _symDiffSplits.size() / (double) combined.size();
+    return (double) getRF() / (double) (_nrTrueSplits + _nrInferredSplits - _nrCommonSplits);
   }
   
   /// Return taxa clustering statistics
@@ -94,16 +94,44 @@ public:
                     int& flipx0_correct, int& flipx0_incorrect) const;
   
 private:
+  /// Count splits using Day's algorithm: the true splits are intervals of
+  /// the leaf order of the true tree, stored in a hash table, and an inferred
+  /// split is shared iff its taxa form such an interval
+  void countSplitsByIntervals();
+  
+  /// Count splits by materializing and intersecting both split sets
+  void countSplitsBySets();
+  
+  /// Compute Rand index, recall and precision of pairs from a contingency table
+  ///
+  /// @param trueClustering True cluster assignment
+  /// @param inferredClustering Inferred cluster assignment
+  /// @param RI Rand index
+  /// @param recall Recall of pairs
+  /// @param precision Precision of pairs
+  static void computeClusteringMetrics(const StlIntVector& trueClustering,
+                                       const StlIntVector& inferredClustering,
+                                       double& RI,
+                                       double& recall,
+                                       double& precision);
+  
+  /// Return number of common elements of two sorted vectors without duplicates
+  ///
+  /// @param sortedA First sorted vector
+  /// @param sortedB Second sorted vector
+  static size_t countIntersection(const PhylogeneticTree::TwoCharStatesVector& sortedA,
+                                  const PhylogeneticTree::TwoCharStatesVector& sortedB);
+  
   /// True phylogenetic tree
   const PhylogeneticTree& _trueT;
   /// Inferred phylogenetic tree
   const PhylogeneticTree& _inferredT;
-  /// True splits
-  PhylogeneticTree::SplitSet _trueSplits;
-  /// Inferred splits
-  PhylogeneticTree::SplitSet _inferredSplits;
-  /// Symmetric difference splits
-  PhylogeneticTree::SplitSet _symDiffSplits;
+  /// Number of distinct true splits
+  int _nrTrueSplits;
+  /// Number of distinct inferred splits
+  int _nrInferredSplits;
+  /// Number of splits shared by both trees
+  int _nrCommonSplits;
 };
 
 #endif // COMPARISON_H
@@ -10,6 +10,7 @@
 //#include "ilpsolverdolloflipclustered.h"
 #include "columngenflipclustered.h"
 #include "cluster.h"
+#include "greedydollo.h"
 
 CoordinateAscent::CoordinateAscent(const Matrix& D,
                                    const StlIntVector& characterMapping,
@@ -34,7 +35,16 @@ CoordinateAscent::CoordinateAscent(const Matrix& D,
   , _zC(_D.getNrCharacters(), 0)
   , _L(0)
   , _baseL(0)
+  , _nrEntries(0)
   , _restart(0)
+  , _level(1)
+  , _greedy(true)
+  , _validE(false)
+  , _raceIterations(0)
+  , _raceMargin(0)
+  , _backend(MipBackend::getDefaultBackend())
+  , _profile()
+  , _budget(NULL)
 {
   // Determine base likelihood based on fixed entries
   const double log_1_minus_alpha = log(1 - _alpha);
@@ -113,12 +123,25 @@ CoordinateAscent::CoordinateAscent(const Matrix& D,
       _multiplicities[pp][cc] = nrTaxa * nrCharacters;
     }
   }
+  
+  // number of observed entries of the original matrix
+  _nrEntries = static_cast<double>(m) * n;
+  for (int pp = 0; pp < mm; ++pp)
+  {
+    for (int cc = 0; cc < nn; ++cc)
+    {
+      if (_D.getEntry(pp, cc) == -1)
+      {
+        _nrEntries -= _multiplicities[pp][cc];
+      }
+    }
+  }
 }
 
 void CoordinateAscent::initZ(int seed)
 {
   Cluster cluster(_D, _s, _t);
-  cluster.cluster(seed);
+  cluster.cluster(seed, _budget);
   _zT = cluster.getTaxonMapping();
   _zC = cluster.getCharacterMapping();
 }
@@ -133,14 +156,18 @@ double CoordinateAscent::solveE(int timeLimit,
   ColumnGenFlipClustered solvePhylogeny(_D, _multiplicities, _baseL,
                                         _k, _lazy, _alpha, _beta,
                                         _t, _zC, _s, _zT);
+  solvePhylogeny.setBackend(_backend);
+  solvePhylogeny.setProfile(_profile);
+  solvePhylogeny.setBudget(_budget);
   solvePhylogeny.init();
-  if (_restart > 1)
+  if (_validE)
   {
     solvePhylogeny.initHotStart(_E);
   }
   success = solvePhylogeny.solve(timeLimit, memoryLimit, nrThreads, verbose);
   
   _E = solvePhylogeny.getSolA();
+  _validE = success;
 #ifdef DEBUG
   InputMatrix::ViolationList violationList;
   assert(_E.identifyViolations(_k, violationList));
@@ -150,6 +177,51 @@ double CoordinateAscent::solveE(int timeLimit,
   return computeLogLikelihood();
 }
 
+void CoordinateAscent::initGreedyE()
+{
+  if (_greedy)
+  {
+    GreedyDollo greedy(getClusteredMatrix(), _k);
+    greedy.solve();
+    _E = greedy.getSolA();
+    _validE = true;
+  }
+}
+
+Matrix CoordinateAscent::getClusteredMatrix() const
+{
+  const int m = _D.getNrTaxa();
+  const int n = _D.getNrCharacters();
+  
+  StlIntMatrix balance(_s, StlIntVector(_t, 0));
+  for (int p = 0; p < m; ++p)
+  {
+    for (int c = 0; c < n; ++c)
+    {
+      int d_pc = _D.getEntry(p, c);
+      if (d_pc == 1)
+      {
+        balance[_zT[p]][_zC[c]] += _multiplicities[p][c];
+      }
+      else if (d_pc == 0)
+      {
+        balance[_zT[p]][_zC[c]] -= _multiplicities[p][c];
+      }
+    }
+  }
+  
+  Matrix D(_s, _t);
+  for (int h = 0; h < _s; ++h)
+  {
+    for (int f = 0; f < _t; ++f)
+    {
+      D.setEntry(h, f, balance[h][f] > 0 ? 1 : (balance[h][f] < 0 ? 0 : -1));
+    }
+  }
+  
+  return D;
+}
+
 double CoordinateAscent::computeCharacterLogLikelihood(int c, int f) const
 {
   const int m = _D.getNrTaxa();
@@ -325,51 +397,183 @@ double CoordinateAscent::solveZT()
   return L;
 }
 
+double CoordinateAscent::iterate(int timeLimit,
+                                 int memoryLimit,
+                                 int nrThreads,
+                                 bool verbose,
+                                 const std::string& label,
+                                 int iteration,
+                                 double L,
+                                 bool& timeLeft)
+{
+  double LLL = solveE(timeLimit, memoryLimit, nrThreads, verbose, timeLeft);
+  std::cerr << label << " -- iteration " << iteration << " -- E step -- log likelihood " << LLL << std::endl;
+//  std::cout << _E << std::endl;
+  assert(!timeLeft || !g_tol.less(LLL, L));
+  
+  double LL = solveZT();
+  std::cerr << label << " -- iteration " << iteration << " -- zT step -- log likelihood " << LL << std::endl;
+  double newL = solveZC();
+  std::cerr << label << " -- iteration " << iteration << " -- zC step -- log likelihood " << newL << std::endl;
+//  std::cout << _E << std::endl;
+  std::cerr << std::endl;
+  
+  return newL;
+}
+
+void CoordinateAscent::ascend(int timeLimit,
+                              int memoryLimit,
+                              int nrThreads,
+                              bool verbose,
+                              const std::string& label,
+                              bool& timeLeft)
+{
+  double delta = 1;
+  int iteration = 1;
+  double L = -std::numeric_limits<double>::max();
+  while (g_tol.nonZero(delta) && iteration <= MAX_ITERATIONS && timeLeft)
+  {
+    double newL = iterate(timeLimit, memoryLimit, nrThreads, verbose,
+                          label, iteration, L, timeLeft);
+    
+    delta = newL - L;
+    _L = newL;
+    L = newL;
+    ++iteration;
+  }
+}
+
+bool CoordinateAscent::solveRacing(int timeLimit,
+                                   int memoryLimit,
+                                   int nrThreads,
+                                   bool verbose,
+                                   int nrRestarts)
+{
+  std::vector<RestartState> restarts(nrRestarts);
+  for (int r = 0; r < nrRestarts; ++r)
+  {
+    RestartState& restart = restarts[r];
+    initZ(_seed + r);
+    restart._zT = _zT;
+    restart._zC = _zC;
+    _E = Matrix(_s, _t);
+    _validE = false;
+    initGreedyE();
+    restart._E = _E;
+    restart._validE = _validE;
+    restart._L = -std::numeric_limits<double>::max();
+    restart._iteration = 1;
+    restart._active = true;
+  }
+  
+  bool timeLeft = true;
+  int nrActive = nrRestarts;
+  while (nrActive > 0 && timeLeft)
+  {
+    // advance all active restarts by the same number of iterations
+    for (int r = 0; r < nrRestarts && timeLeft; ++r)
+    {
+      RestartState& restart = restarts[r];
+      if (!restart._active)
+        continue;
+      
+      _restart = r + 1;
+      _E = restart._E;
+      _validE = restart._validE;
+      _zT = restart._zT;
+      _zC = restart._zC;
+      for (int i = 0; i < _raceIterations && restart._active && timeLeft; ++i)
+      {
+        double newL = iterate(timeLimit, memoryLimit, nrThreads, verbose,
+                              "Restart " + std::to_string(_restart),
+                              restart._iteration, restart._L, timeLeft);
+        double delta = newL - restart._L;
+        restart._L = newL;
+        ++restart._iteration;
+        if (!g_tol.nonZero(delta) || restart._iteration > MAX_ITERATIONS)
+        {
+          restart._active = false;
+          --nrActive;
+        }
+      }
+      restart._E = _E;
+      restart._validE = _validE;
+      restart._zT = _zT;
+      restart._zC = _zC;
+    }
+    
+    // stop the restarts that trail the leader by more than the margin
+    double leaderL = -std::numeric_limits<double>::max();
+    for (const RestartState& restart : restarts)
+    {
+      leaderL = std::max(leaderL, restart._L);
+    }
+    for (int r = 0; r < nrRestarts; ++r)
+    {
+      RestartState& restart = restarts[r];
+      if (restart._active && restart._L < leaderL - _raceMargin * fabs(leaderL))
+      {
+        std::cerr << "Restart " << r + 1 << " -- stopped after iteration "
+                  << restart._iteration - 1 << " -- log likelihood "
+                  << restart._L << " trails " << leaderL << std::endl;
+        restart._active = false;
+        --nrActive;
+      }
+    }
+  }
+  
+  int best = -1;
+  for (int r = 0; r < nrRestarts; ++r)
+  {
+    if (restarts[r]._iteration > 1
+        && (best == -1 || restarts[best]._L < restarts[r]._L))
+    {
+      best = r;
+    }
+  }
+  if (best != -1)
+  {
+    _E = restarts[best]._E;
+    _validE = restarts[best]._validE;
+    _zT = restarts[best]._zT;
+    _zC = restarts[best]._zC;
+    _L = restarts[best]._L;
+  }
+  
+  return true;
+}
+
 bool CoordinateAscent::solve(int timeLimit,
                              int memoryLimit,
                              int nrThreads,
                              bool verbose,
                              int nrRestarts)
 {
-  // MEK: limit maximum number of iterations in one restart
-  const int maxIterations = 100;
+  if (_raceIterations > 0)
+  {
+    return solveRacing(timeLimit, memoryLimit, nrThreads, verbose, nrRestarts);
+  }
   
   Matrix bestA(_D.getNrTaxa(), _E.getNrCharacters());
   double bestLikelihood = computeLogLikelihood();
   _L = bestLikelihood;
+  bool bestValidE = false;
   StlIntVector bestZT = _zT, bestZC = _zC;
   
   bool timeLeft = true;
   for (_restart = 1; _restart <= nrRestarts && timeLeft; ++_restart)
   {
     initZ(_seed + _restart - 1);
+    // without greedy MIP starts, the E of the previous restart is kept
+    initGreedyE();
     
-    double delta = 1;
-    int iteration = 1;
-    double L = -std::numeric_limits<double>::max();
-    while (g_tol.nonZero(delta) && iteration <= maxIterations && timeLeft)
-    {
-      double LLL = solveE(timeLimit, memoryLimit, nrThreads, verbose, timeLeft);
-      std::cerr << "Restart " << _restart << " -- iteration " << iteration << " -- E step -- log likelihood " << LLL << std::endl;
-//      std::cout << _E << std::endl;
-      assert(!timeLeft || !g_tol.less(LLL, L));
-      
-      double LL = solveZT();
-      std::cerr << "Restart " << _restart << " -- iteration " << iteration << " -- zT step -- log likelihood " << LL << std::endl;
-      double newL = solveZC();
-      std::cerr << "Restart " << _restart << " -- iteration " << iteration << " -- zC step -- log likelihood " << newL << std::endl;
-//      std::cout << _E << std::endl;
-      std::cerr << std::endl;
-      
-      delta = newL - L;
-      _L = newL;
-      L = newL;
-      ++iteration;
-    }
+    ascend(timeLimit, memoryLimit, nrThreads, verbose,
+           "Restart " + std::to_string(_restart), timeLeft);
     
     if (bestLikelihood < _L)
     {
       bestA = _E;
+      bestValidE = _validE;
       bestLikelihood = _L;
       bestZT = _zT;
       bestZC = _zC;
@@ -377,9 +581,346 @@ bool CoordinateAscent::solve(int timeLimit,
   }
   
   _E = bestA;
+  _validE = bestValidE;
   _L = bestLikelihood;
   _zT = bestZT;
   _zC = bestZC;
   
   return true;
 }
+
+bool CoordinateAscent::solveMultilevel(int timeLimit,
+                                       int memoryLimit,
+                                       int nrThreads,
+                                       bool verbose,
+                                       int nrRestarts,
+                                       int nrLevels)
+{
+  const int targetS = _s;
+  const int targetT = _t;
+  
+  // the number of clusters doubles at every level, rounding up at the
+  // coarsest level ensures that the last level can reach the target
+  assert(1 <= nrLevels && nrLevels < 32);
+  const int divisor = 1 << (nrLevels - 1);
+  _level = 1;
+  _s = std::max(1, (targetS + divisor - 1) / divisor);
+  _t = std::max(1, (targetT + divisor - 1) / divisor);
+  _E = Matrix(_s, _t);
+  _validE = false;
+  std::cerr << "Level 1 -- " << _s << " taxon clusters, "
+            << _t << " character clusters" << std::endl;
+  solve(timeLimit, memoryLimit, nrThreads, verbose, nrRestarts);
+  
+  bool timeLeft = !(_budget && _budget->exceeded())
+    && (timeLimit == -1 || g_timer.realTime() <= timeLimit);
+  while ((_s < targetS || _t < targetT) && timeLeft)
+  {
+    ++_level;
+    if (_level == nrLevels)
+    {
+      // keep splitting until the target is reached or no cluster has two
+      // members left
+      for (int s = -1; _s < targetS && _s != s;)
+      {
+        s = _s;
+        splitTaxonClusters(targetS - _s);
+      }
+      for (int t = -1; _t < targetT && _t != t;)
+      {
+        t = _t;
+        splitCharacterClusters(targetT - _t);
+      }
+    }
+    else
+    {
+      splitTaxonClusters(std::min(_s, targetS - _s));
+      splitCharacterClusters(std::min(_t, targetT - _t));
+    }
+    std::cerr << "Level " << _level << " -- " << _s << " taxon clusters, "
+              << _t << " character clusters" << std::endl;
+    
+    Matrix prevE = _E;
+    bool prevValidE = _validE;
+    StlIntVector prevZT = _zT, prevZC = _zC;
+    double prevL = _L = computeLogLikelihood();
+    
+    ascend(timeLimit, memoryLimit, nrThreads, verbose,
+           "Level " + std::to_string(_level), timeLeft);
+    
+    if (g_tol.less(_L, prevL))
+    {
+      // an interrupted E step may have returned a worse solution
+      _E = prevE;
+      _validE = prevValidE;
+      _zT = prevZT;
+      _zC = prevZC;
+      _L = prevL;
+    }
+    
+    if (_level == nrLevels)
+      break;
+  }
+  
+  return true;
+}
+
+bool CoordinateAscent::solveAutomatic(int timeLimit,
+                                      int memoryLimit,
+                                      int nrThreads,
+                                      bool verbose,
+                                      int nrRestarts,
+                                      int patience)
+{
+  const int maxS = _s;
+  const int maxT = _t;
+  
+  _level = 1;
+  _s = std::min(2, maxS);
+  _t = std::min(2, maxT);
+  _E = Matrix(_s, _t);
+  _validE = false;
+  solve(timeLimit, memoryLimit, nrThreads, verbose, nrRestarts);
+  
+  Matrix bestE = _E;
+  StlIntVector bestZT = _zT, bestZC = _zC;
+  double bestL = _L;
+  int bestS = _s, bestT = _t;
+  double bestBIC = getBIC();
+  std::cerr << "Clusters " << _s << " x " << _t << " -- log likelihood "
+            << _L << " -- BIC " << bestBIC << std::endl;
+  
+  bool timeLeft = !(_budget && _budget->exceeded())
+    && (timeLimit == -1 || g_timer.realTime() <= timeLimit);
+  int nrStepsWithoutImprovement = 0;
+  while (timeLeft && nrStepsWithoutImprovement < patience)
+  {
+    ++_level;
+    
+    // candidates split the worst-fitting taxon or character cluster
+    // of the current clustering, the one with the smaller BIC is kept
+    const Matrix E = _E;
+    const bool validE = _validE;
+    const StlIntVector zT = _zT, zC = _zC;
+    const int s = _s, t = _t;
+    
+    bool found = false;
+    Matrix candE;
+    bool candValidE = false;
+    StlIntVector candZT, candZC;
+    double candL = 0, candBIC = 0;
+    int candS = 0, candT = 0;
+    for (int move = 0; move < 2 && timeLeft; ++move)
+    {
+      _E = E;
+      _validE = validE;
+      _zT = zT;
+      _zC = zC;
+      _s = s;
+      _t = t;
+      if (move == 0 && _s < maxS)
+      {
+        splitTaxonClusters(1);
+      }
+      else if (move == 1 && _t < maxT)
+      {
+        splitCharacterClusters(1);
+      }
+      if (_s == s && _t == t)
+        continue;
+      
+      ascend(timeLimit, memoryLimit, nrThreads, verbose,
+             "Clusters " + std::to_string(_s) + " x " + std::to_string(_t),
+             timeLeft);
+      if (!timeLeft)
+        break;
+      
+      double BIC = getBIC();
+      std::cerr << "Clusters " << _s << " x " << _t << " -- log likelihood "
+                << _L << " -- BIC " << BIC << std::endl;
+      if (!found || BIC < candBIC)
+      {
+        found = true;
+        candE = _E;
+        candValidE = _validE;
+        candZT = _zT;
+        candZC = _zC;
+        candL = _L;
+        candBIC = BIC;
+        candS = _s;
+        candT = _t;
+      }
+    }
+    
+    if (!found)
+      break;
+    
+    _E = candE;
+    _validE = candValidE;
+    _zT = candZT;
+    _zC = candZC;
+    _L = candL;
+    _s = candS;
+    _t = candT;
+    if (candBIC < bestBIC)
+    {
+      bestE = candE;
+      bestZT = candZT;
+      bestZC = candZC;
+      bestL = candL;
+      bestBIC = candBIC;
+      bestS = candS;
+      bestT = candT;
+      nrStepsWithoutImprovement = 0;
+    }
+    else
+    {
+      ++nrStepsWithoutImprovement;
+    }
+  }
+  
+  _E = bestE;
+  _zT = bestZT;
+  _zC = bestZC;
+  _L = bestL;
+  _s = bestS;
+  _t = bestT;
+  std::cerr << "Selected " << _s << " taxon clusters and " << _t
+            << " character clusters -- BIC " << bestBIC << std::endl;
+  
+  return true;
+}
+
+void CoordinateAscent::splitTaxonClusters(int nrSplits)
+{
+  const int m = _D.getNrTaxa();
+  
+  StlIntMatrix members(_s);
+  StlDoubleVector fit(m, 0);
+  StlDoubleVector clusterFit(_s, 0);
+  for (int p = 0; p < m; ++p)
+  {
+    members[_zT[p]].push_back(p);
+    fit[p] = computeTaxonLogLikelihood(p, _zT[p]);
+    clusterFit[_zT[p]] += fit[p];
+  }
+  
+  // split the clusters with the smallest log likelihood first
+  StlIntVector order;
+  for (int h = 0; h < _s; ++h)
+  {
+    if (members[h].size() > 1)
+    {
+      order.push_back(h);
+    }
+  }
+  std::sort(order.begin(), order.end(), [&clusterFit](int h1, int h2)
+  {
+    return clusterFit[h1] < clusterFit[h2];
+  });
+  if (order.size() > static_cast<size_t>(nrSplits))
+  {
+    order.resize(nrSplits);
+  }
+  
+  const int newS = _s + order.size();
+  Matrix E(newS, _t);
+  for (int h = 0; h < _s; ++h)
+  {
+    for (int f = 0; f < _t; ++f)
+    {
+      E.setEntry(h, f, _E.getEntry(h, f));
+    }
+  }
+  
+  int newH = _s;
+  for (int h : order)
+  {
+    // the new cluster starts as a copy of h, which keeps E a k-Dollo
+    // completion, and receives the worst-fitting half of the members
+    for (int f = 0; f < _t; ++f)
+    {
+      E.setEntry(newH, f, _E.getEntry(h, f));
+    }
+    StlIntVector& taxa = members[h];
+    std::sort(taxa.begin(), taxa.end(), [&fit](int p1, int p2)
+    {
+      return fit[p1] < fit[p2];
+    });
+    for (size_t idx = 0; idx < taxa.size() / 2; ++idx)
+    {
+      _zT[taxa[idx]] = newH;
+    }
+    ++newH;
+  }
+  
+  _s = newS;
+  _E = E;
+}
+
+void CoordinateAscent::splitCharacterClusters(int nrSplits)
+{
+  const int n = _D.getNrCharacters();
+  
+  StlIntMatrix members(_t);
+  StlDoubleVector fit(n, 0);
+  StlDoubleVector clusterFit(_t, 0);
+  for (int c = 0; c < n; ++c)
+  {
+    members[_zC[c]].push_back(c);
+    fit[c] = computeCharacterLogLikelihood(c, _zC[c]);
+    clusterFit[_zC[c]] += fit[c];
+  }
+  
+  // split the clusters with the smallest log likelihood first
+  StlIntVector order;
+  for (int f = 0; f < _t; ++f)
+  {
+    if (members[f].size() > 1)
+    {
+      order.push_back(f);
+    }
+  }
+  std::sort(order.begin(), order.end(), [&clusterFit](int f1, int f2)
+  {
+    return clusterFit[f1] < clusterFit[f2];
+  });
+  if (order.size() > static_cast<size_t>(nrSplits))
+  {
+    order.resize(nrSplits);
+  }
+  
+  const int newT = _t + order.size();
+  Matrix E(_s, newT);
+  for (int h = 0; h < _s; ++h)
+  {
+    for (int f = 0; f < _t; ++f)
+    {
+      E.setEntry(h, f, _E.getEntry(h, f));
+    }
+  }
+  
+  int newF = _t;
+  for (int f : order)
+  {
+    // the new cluster starts as a copy of f, which keeps E a k-Dollo
+    // completion, and receives the worst-fitting half of the members
+    for (int h = 0; h < _s; ++h)
+    {
+      E.setEntry(h, newF, _E.getEntry(h, f));
+    }
+    StlIntVector& characters = members[f];
+    std::sort(characters.begin(), characters.end(), [&fit](int c1, int c2)
+    {
+      return fit[c1] < fit[c2];
+    });
+    for (size_t idx = 0; idx < characters.size() / 2; ++idx)
+    {
+      _zC[characters[idx]] = newF;
+    }
+    ++newF;
+  }
+  
+  _t = newT;
+  _E = E;
+}
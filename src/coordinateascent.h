@@ -10,6 +10,8 @@
 
 #include "utils.h"
 #include "matrix.h"
+#include "solverprofile.h"
+#include "budget.h"
 
 /// This class provides a coordinate-ascent based approach to the k-DPFC problem
 class CoordinateAscent
@@ -51,6 +53,46 @@ public:
              bool verbose,
              int nrRestarts);
   
+  /// Solve by coarsening and refining. The first level solves for the
+  /// number of clusters divided by 2^(nrLevels - 1), rounded up, using
+  /// nrRestarts restarts. Each subsequent level doubles the number of clusters, up to
+  /// the given numbers of taxon and character clusters, by splitting the
+  /// worst-fitting clusters, and is warm started with the previous solution.
+  ///
+  /// @param timeLimit Time limit in seconds
+  /// @param memoryLimit Memory limit in megabytes
+  /// @param nrThreads Number of threads the solver can use
+  /// @param verbose Set to true to enable ILP solver output
+  /// @param nrRestarts Number of restarts at the coarsest level
+  /// @param nrLevels Number of levels, between 1 and 31
+  bool solveMultilevel(int timeLimit,
+                       int memoryLimit,
+                       int nrThreads,
+                       bool verbose,
+                       int nrRestarts,
+                       int nrLevels);
+  
+  /// Solve with automatic selection of the number of clusters. Starting from
+  /// two taxon and two character clusters, each step splits either the
+  /// worst-fitting taxon cluster or the worst-fitting character cluster,
+  /// whichever results in the smaller BIC, and is warm started with the
+  /// previous solution. The search stops once the BIC did not improve for
+  /// the given number of steps or the numbers of clusters passed to the
+  /// constructor are reached; the solution with the smallest BIC is kept.
+  ///
+  /// @param timeLimit Time limit in seconds
+  /// @param memoryLimit Memory limit in megabytes
+  /// @param nrThreads Number of threads the solver can use
+  /// @param verbose Set to true to enable ILP solver output
+  /// @param nrRestarts Number of restarts for the initial clustering
+  /// @param patience Number of steps without improvement
+  bool solveAutomatic(int timeLimit,
+                      int memoryLimit,
+                      int nrThreads,
+                      bool verbose,
+                      int nrRestarts,
+                      int patience);
+  
   /// Return solution matrix (k-Dollo completion)
   const Matrix& getE() const
   {
@@ -75,10 +117,163 @@ public:
     return _L;
   }
   
-private:
+  /// Return Bayesian information criterion -2 L + s t ln N, where the
+  /// s t entries of the completion are the free parameters and N is the
+  /// number of observed entries
+  double getBIC() const
+  {
+    return -2 * _L + _s * _t * log(_nrEntries);
+  }
+  
+  /// Return number of taxon clusters
+  int getNrTaxonClusters() const
+  {
+    return _s;
+  }
+  
+  /// Return number of character clusters
+  int getNrCharacterClusters() const
+  {
+    return _t;
+  }
+  
+  /// Set MIP backend
+  ///
+  /// @param backend Backend name
+  void setBackend(const std::string& backend)
+  {
+    _backend = backend;
+  }
+  
+  /// Set solver profile
+  ///
+  /// @param profile Solver profile
+  void setProfile(const SolverProfile& profile)
+  {
+    _profile = profile;
+  }
+  
+  /// Set resource budget shared by clustering and E steps
+  ///
+  /// @param budget Budget, may be NULL
+  void setBudget(Budget* budget)
+  {
+    _budget = budget;
+  }
+  
+  /// Race restarts: all restarts are advanced in rounds of the given number
+  /// of iterations, after each round the restarts whose log likelihood
+  /// trails the best one by more than margin * |best| are stopped
+  ///
+  /// @param iterationsPerRound Number of iterations per round, 0 disables racing
+  /// @param margin Relative log likelihood margin
+  void setRacing(int iterationsPerRound, double margin)
+  {
+    _raceIterations = iterationsPerRound;
+    _raceMargin = margin;
+  }
+  
+  /// Set whether the first E step of every restart is warm started by a
+  /// greedy completion
+  ///
+  /// @param greedy Enable greedy MIP start
+  void setGreedy(bool greedy)
+  {
+    _greedy = greedy;
+  }
+  
+protected:
+  /// State of a restart during racing
+  struct RestartState
+  {
+    /// Output matrix
+    Matrix _E;
+    /// Indicates whether _E warm starts the next E step
+    bool _validE;
+    /// Taxon cluster assignment
+    StlIntVector _zT;
+    /// Character cluster assignment
+    StlIntVector _zC;
+    /// Log likelihood
+    double _L;
+    /// Next iteration
+    int _iteration;
+    /// Indicates whether the restart has neither converged nor been stopped
+    bool _active;
+  };
+  
+  // MEK: limit maximum number of iterations in one restart
+  static const int MAX_ITERATIONS = 100;
+  
+  /// Solve by racing restarts, see setRacing
+  ///
+  /// @param timeLimit Time limit in seconds
+  /// @param memoryLimit Memory limit in megabytes
+  /// @param nrThreads Number of threads the solver can use
+  /// @param verbose Set to true to enable ILP solver output
+  /// @param nrRestarts Number of restarts
+  bool solveRacing(int timeLimit,
+                   int memoryLimit,
+                   int nrThreads,
+                   bool verbose,
+                   int nrRestarts);
+  
   /// Initialize clustering of taxa and characters
   void initZ(int seed);
   
+  /// Perform a single E, zT and zC step. Return log likelihood.
+  ///
+  /// @param timeLimit Time limit in seconds
+  /// @param memoryLimit Memory limit in megabytes
+  /// @param nrThreads Number of threads the solver can use
+  /// @param verbose Set to true to enable ILP solver output
+  /// @param label Log message prefix
+  /// @param iteration Iteration
+  /// @param L Log likelihood of the previous iteration
+  /// @param timeLeft Indicates whether the E step succeeded
+  double iterate(int timeLimit,
+                 int memoryLimit,
+                 int nrThreads,
+                 bool verbose,
+                 const std::string& label,
+                 int iteration,
+                 double L,
+                 bool& timeLeft);
+  
+  /// Alternate E, zT and zC steps until convergence, starting from the
+  /// current clustering
+  ///
+  /// @param timeLimit Time limit in seconds
+  /// @param memoryLimit Memory limit in megabytes
+  /// @param nrThreads Number of threads the solver can use
+  /// @param verbose Set to true to enable ILP solver output
+  /// @param label Log message prefix
+  /// @param timeLeft Indicates whether the last E step succeeded
+  void ascend(int timeLimit,
+              int memoryLimit,
+              int nrThreads,
+              bool verbose,
+              const std::string& label,
+              bool& timeLeft);
+  
+  /// Split the taxon clusters with the smallest log likelihood. The new
+  /// cluster receives the worst-fitting half of the taxa and a copy of the
+  /// row of E.
+  ///
+  /// @param nrSplits Maximum number of clusters to split
+  void splitTaxonClusters(int nrSplits);
+  
+  /// Split the character clusters with the smallest log likelihood. The new
+  /// cluster receives the worst-fitting half of the characters and a copy of
+  /// the column of E.
+  ///
+  /// @param nrSplits Maximum number of clusters to split
+  void splitCharacterClusters(int nrSplits);
+  
+  /// Set E to the greedy completion of the clustered matrix if greedy
+  /// MIP starts are enabled, called at the start of every restart
+  void initGreedyE();
+  
   /// Solve the k-DPFC subproblem given taxon and character clustering. Return log likelihood.
   ///
   /// @param timeLimit Time limit in seconds
@@ -122,7 +317,12 @@ private:
   /// Compute log likelihood
   double computeLogLikelihood() const;
   
-private:
+  /// Return clustered input matrix, each entry is the weighted majority
+  /// of the observed entries of the corresponding cluster pair
+  /// and -1 if there is no majority
+  Matrix getClusteredMatrix() const;
+  
+protected:
   /// Input matrix
   const Matrix& _D;
   /// Maximum number of losses
@@ -134,9 +334,9 @@ private:
   /// False positive rate
   const double _beta;
   /// Number of cell clusters
-  const int _s;
+  int _s;
   /// Number of character clusters
-  const int _t;
+  int _t;
   /// Random number generator seed
   const int _seed;
   /// Output matrix
@@ -149,10 +349,29 @@ private:
   double _L;
   /// Number of correct characters
   double _baseL;
+  /// Number of observed entries of the original matrix
+  double _nrEntries;
   /// Multiplicative matrix
   StlIntMatrix _multiplicities;
   /// Restart count
   int _restart;
+  /// Level of multilevel solve, 1 is the coarsest
+  int _level;
+  /// Warm start first E step of every restart by a greedy completion
+  bool _greedy;
+  /// Indicates whether _E is a k-Dollo completion that warm starts the
+  /// next E step
+  bool _validE;
+  /// Number of iterations per racing round, 0 if racing is disabled
+  int _raceIterations;
+  /// Relative log likelihood margin of racing
+  double _raceMargin;
+  /// MIP backend name
+  std::string _backend;
+  /// Solver profile
+  SolverProfile _profile;
+  /// Resource budget, may be NULL
+  Budget* _budget;
 };
 
 #endif // COORDINATEASCENT_H
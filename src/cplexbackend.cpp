@@ -0,0 +1,375 @@
+/*
+ * cplexbackend.cpp
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#include "cplexbackend.h"
+
+/// This class calls the separation callback of a CplexBackend from a CPLEX
+/// user cut (T = IloCplex::UserCutCallbackI) or lazy constraint callback
+/// (T = IloCplex::LazyConstraintCallbackI)
+template<class T>
+class CplexSeparationCallback : public T
+{
+public:
+  /// Constructor
+  ///
+  /// @param env Environment
+  /// @param vars Variables
+  /// @param pCallback Separation callback
+  /// @param pMutex Mutex serializing the retrieval of values
+  CplexSeparationCallback(IloEnv env,
+                          const IloBoolVarArray& vars,
+                          const MipBackend::SeparationCallback* pCallback,
+                          IloFastMutex* pMutex)
+    : T(env)
+    , _vars(vars)
+    , _pCallback(pCallback)
+    , _pMutex(pMutex)
+    , _maxIterations(100)
+    , _currentIterations(0)
+  {
+  }
+  
+  IloCplex::CallbackI* duplicateCallback() const
+  {
+    return (new (T::getEnv()) CplexSeparationCallback(*this));
+  }
+  
+  void main();
+  
+private:
+  /// Add rows violated by the current values
+  void separate();
+  
+private:
+  /// Variables
+  IloBoolVarArray _vars;
+  /// Separation callback
+  const MipBackend::SeparationCallback* _pCallback;
+  /// Mutex serializing the retrieval of values
+  IloFastMutex* _pMutex;
+  /// Maximum number of rounds of user cuts
+  int _maxIterations;
+  /// Number of rounds of user cuts
+  int _currentIterations;
+};
+
+template<class T>
+void CplexSeparationCallback<T>::separate()
+{
+  if (!*_pCallback)
+    return;
+  
+  IloNumArray cplexVals(T::getEnv(), _vars.getSize());
+  _pMutex->lock();
+  T::getValues(cplexVals, _vars);
+  _pMutex->unlock();
+  
+  StlDoubleVector vals(cplexVals.getSize());
+  for (IloInt idx = 0; idx < cplexVals.getSize(); ++idx)
+  {
+    vals[idx] = cplexVals[idx];
+  }
+  cplexVals.end();
+  
+  MipBackend::RowVector rows;
+  (*_pCallback)(vals, rows);
+  for (const MipBackend::Row& row : rows)
+  {
+    T::add(CplexBackend::toRange(T::getEnv(), _vars, row),
+           IloCplex::UseCutPurge).end();
+  }
+}
+
+template<>
+void CplexSeparationCallback<IloCplex::UserCutCallbackI>::main()
+{
+  // cuts only strengthen the relaxation, stop after a fixed number of rounds
+  if (_currentIterations == _maxIterations)
+  {
+    abortCutLoop();
+    return;
+  }
+  _currentIterations++;
+  
+  separate();
+}
+
+template<>
+void CplexSeparationCallback<IloCplex::LazyConstraintCallbackI>::main()
+{
+  // every integer solution must be checked for violated lazy constraints
+  separate();
+}
+
+/// This class calls the incumbent callback of a CplexBackend from a CPLEX
+/// incumbent callback
+class CplexIncumbentCallback : public IloCplex::IncumbentCallbackI
+{
+public:
+  /// Constructor
+  ///
+  /// @param env Environment
+  /// @param vars Variables
+  /// @param pCallback Incumbent callback
+  CplexIncumbentCallback(IloEnv env,
+                         const IloBoolVarArray& vars,
+                         const MipBackend::IncumbentCallback* pCallback)
+    : IloCplex::IncumbentCallbackI(env)
+    , _vars(vars)
+    , _pCallback(pCallback)
+  {
+  }
+  
+  IloCplex::CallbackI* duplicateCallback() const
+  {
+    return (new (getEnv()) CplexIncumbentCallback(*this));
+  }
+  
+  void main()
+  {
+    if (!*_pCallback)
+      return;
+    
+    IloNumArray cplexVals(getEnv(), _vars.getSize());
+    getValues(cplexVals, _vars);
+    
+    StlDoubleVector vals(cplexVals.getSize());
+    for (IloInt idx = 0; idx < cplexVals.getSize(); ++idx)
+    {
+      vals[idx] = cplexVals[idx];
+    }
+    cplexVals.end();
+    
+    (*_pCallback)(vals);
+  }
+  
+private:
+  /// Variables
+  IloBoolVarArray _vars;
+  /// Incumbent callback
+  const MipBackend::IncumbentCallback* _pCallback;
+};
+
+CplexBackend::CplexBackend()
+  : _env()
+  , _model(_env)
+  , _obj(_env)
+  , _cplex(_model)
+  , _aborter(_env)
+  , _vars(_env)
+  , _detTime(0)
+  , _incumbentCallback()
+  , _separationCallback()
+  , _mutex()
+{
+  _cplex.use(_aborter);
+  _model.add(_obj);
+}
+
+CplexBackend::~CplexBackend()
+{
+  _cplex.end();
+  _model.end();
+  _env.end();
+}
+
+int CplexBackend::addBinaryVariable(const std::string& name)
+{
+  _vars.add(IloBoolVar(_env, name.c_str()));
+  return _vars.getSize() - 1;
+}
+
+IloRange CplexBackend::toRange(IloEnv env,
+                              const IloBoolVarArray& vars,
+                              const Row& row)
+{
+  IloExpr sum(env);
+  for (size_t idx = 0; idx < row._vars.size(); ++idx)
+  {
+    sum += row._coefs[idx] * vars[row._vars[idx]];
+  }
+  
+  IloRange range(env,
+                 row._lb == -INF ? -IloInfinity : row._lb,
+                 sum,
+                 row._ub == INF ? IloInfinity : row._ub);
+  sum.end();
+  
+  return range;
+}
+
+void CplexBackend::addRow(const Row& row)
+{
+  _model.add(toRange(_env, _vars, row));
+}
+
+void CplexBackend::addLazyRows(const RowVector& rows)
+{
+  IloConstraintArray lazyConstraints(_env);
+  for (const Row& row : rows)
+  {
+    lazyConstraints.add(toRange(_env, _vars, row));
+  }
+  _cplex.addLazyConstraints(lazyConstraints);
+  _cplex.addUserCuts(lazyConstraints);
+}
+
+void CplexBackend::setIncumbentCallback(const IncumbentCallback& callback)
+{
+  // the CPLEX callback is registered once and calls the current callback
+  if (!_incumbentCallback && callback)
+  {
+    _cplex.use(IloCplex::Callback(new (_env) CplexIncumbentCallback(_env, _vars, &_incumbentCallback)));
+  }
+  _incumbentCallback = callback;
+}
+
+void CplexBackend::setSeparationCallback(const SeparationCallback& callback)
+{
+  // the CPLEX callbacks are registered once and call the current callback
+  if (!_separationCallback && callback)
+  {
+    _cplex.use(IloCplex::Callback(new (_env) CplexSeparationCallback<IloCplex::UserCutCallbackI>(_env, _vars, &_separationCallback, &_mutex)));
+    _cplex.use(IloCplex::Callback(new (_env) CplexSeparationCallback<IloCplex::LazyConstraintCallbackI>(_env, _vars, &_separationCallback, &_mutex)));
+  }
+  _separationCallback = callback;
+}
+
+void CplexBackend::setObjective(const StlDoubleVector& coefs,
+                                double constant,
+                                bool maximize)
+{
+  IloExpr obj(_env);
+  for (size_t idx = 0; idx < coefs.size(); ++idx)
+  {
+    if (coefs[idx] != 0)
+    {
+      obj += coefs[idx] * _vars[idx];
+    }
+  }
+  obj += constant;
+  
+  _obj.setExpr(obj);
+  _obj.setSense(maximize ? IloObjective::Maximize : IloObjective::Minimize);
+  obj.end();
+}
+
+void CplexBackend::addMIPStart(const StlIntVector& vars,
+                               const StlDoubleVector& vals)
+{
+  IloNumVarArray startVar(_env);
+  IloNumArray startVal(_env);
+  for (size_t idx = 0; idx < vars.size(); ++idx)
+  {
+    startVar.add(_vars[vars[idx]]);
+    startVal.add(vals[idx]);
+  }
+  
+  _cplex.addMIPStart(startVar, startVal);
+  startVar.end();
+  startVal.end();
+}
+
+void CplexBackend::setParameters(int timeLimit,
+                                 int memoryLimit,
+                                 int nrThreads,
+                                 bool verbose)
+{
+  if (!verbose)
+  {
+    _env.setOut(_env.getNullStream());
+    _env.setError(_env.getNullStream());
+    _env.setWarning(_env.getNullStream());
+    _cplex.setOut(_env.getNullStream());
+    _cplex.setError(_env.getNullStream());
+    _cplex.setWarning(_env.getNullStream());
+  }
+  else
+  {
+    _env.setOut(std::cerr);
+    _env.setError(std::cerr);
+    _env.setWarning(std::cerr);
+    _cplex.setOut(std::cerr);
+    _cplex.setError(std::cerr);
+    _cplex.setWarning(std::cerr);
+  }
+  
+  _cplex.setParam(IloCplex::ParallelMode, -1);
+  if (nrThreads > 0)
+  {
+    _cplex.setParam(IloCplex::Threads, nrThreads);
+  }
+  if (timeLimit > 0)
+  {
+    _cplex.setParam(IloCplex::TiLim, timeLimit);
+  }
+  if (memoryLimit > 0)
+  {
+    _cplex.setParam(IloCplex::WorkMem, memoryLimit);
+  }
+}
+
+void CplexBackend::applyProfile(IloCplex cplex, const SolverProfile& profile)
+{
+  if (profile.hasParam("emphasis"))
+  {
+    cplex.setParam(IloCplex::MIPEmphasis, static_cast<int>(profile.getParam("emphasis")));
+  }
+  if (profile.hasParam("cuts"))
+  {
+    const int cuts = static_cast<int>(profile.getParam("cuts"));
+    cplex.setParam(IloCplex::Cliques, cuts);
+    cplex.setParam(IloCplex::Covers, cuts);
+    cplex.setParam(IloCplex::DisjCuts, cuts);
+    cplex.setParam(IloCplex::FlowCovers, cuts);
+    cplex.setParam(IloCplex::GUBCovers, cuts);
+    cplex.setParam(IloCplex::ImplBd, cuts);
+    cplex.setParam(IloCplex::LiftProjCuts, cuts);
+    cplex.setParam(IloCplex::MCFCuts, cuts);
+    cplex.setParam(IloCplex::MIRCuts, cuts);
+    cplex.setParam(IloCplex::ZeroHalfCuts, cuts);
+  }
+  if (profile.hasParam("probe"))
+  {
+    cplex.setParam(IloCplex::Probe, static_cast<int>(profile.getParam("probe")));
+  }
+  if (profile.hasParam("heuristicfreq"))
+  {
+    cplex.setParam(IloCplex::HeurFreq, static_cast<int>(profile.getParam("heuristicfreq")));
+  }
+  if (profile.hasParam("varsel"))
+  {
+    cplex.setParam(IloCplex::VarSel, static_cast<int>(profile.getParam("varsel")));
+  }
+  if (profile.hasParam("mipgap"))
+  {
+    cplex.setParam(IloCplex::EpGap, profile.getParam("mipgap"));
+  }
+}
+
+bool CplexBackend::solve()
+{
+  double startDetTime = _cplex.getDetTime();
+  _cplex.solve();
+  _detTime = _cplex.getDetTime() - startDetTime;
+  return _cplex.getStatus() == IloAlgorithm::Optimal
+    && _cplex.getCplexStatus() != IloCplex::AbortTimeLim
+    && _cplex.getCplexStatus() != IloCplex::AbortDetTimeLim;
+}
+
+void CplexBackend::getValues(StlDoubleVector& vals) const
+{
+  IloNumArray cplexVals(_env, _vars.getSize());
+  _cplex.getValues(cplexVals, _vars);
+  
+  vals.resize(cplexVals.getSize());
+  for (IloInt idx = 0; idx < cplexVals.getSize(); ++idx)
+  {
+    vals[idx] = cplexVals[idx];
+  }
+  cplexVals.end();
+}
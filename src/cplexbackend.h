@@ -0,0 +1,140 @@
+/*
+ * cplexbackend.h
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#ifndef CPLEXBACKEND_H
+#define CPLEXBACKEND_H
+
+#include <ilcplex/ilocplex.h>
+#include <ilconcert/ilothread.h>
+#include "mipbackend.h"
+
+/// This class implements the MIP backend using CPLEX
+class CplexBackend : public MipBackend
+{
+public:
+  /// Constructor
+  CplexBackend();
+
+  /// Destructor
+  virtual ~CplexBackend();
+
+  virtual int addBinaryVariable(const std::string& name);
+
+  virtual int getNrVariables() const
+  {
+    return _vars.getSize();
+  }
+
+  virtual void setUpperBound(int var, double ub)
+  {
+    _vars[var].setUB(ub);
+  }
+
+  virtual void addRow(const Row& row);
+
+  virtual void addLazyRows(const RowVector& rows);
+
+  virtual int getNrRows() const
+  {
+    return _cplex.getNrows();
+  }
+
+  virtual void setIncumbentCallback(const IncumbentCallback& callback);
+
+  virtual void setSeparationCallback(const SeparationCallback& callback);
+
+  virtual void setObjective(const StlDoubleVector& coefs,
+                            double constant,
+                            bool maximize);
+
+  virtual void addMIPStart(const StlIntVector& vars,
+                           const StlDoubleVector& vals);
+
+  virtual void setParameters(int timeLimit,
+                             int memoryLimit,
+                             int nrThreads,
+                             bool verbose);
+
+  virtual void setProfile(const SolverProfile& profile)
+  {
+    applyProfile(_cplex, profile);
+  }
+
+  virtual void setDeterministicTimeLimit(double ticks)
+  {
+    _cplex.setParam(IloCplex::DetTiLim, ticks < 0 ? 1e75 : ticks);
+  }
+  
+  virtual double getDeterministicTime() const
+  {
+    return _detTime;
+  }
+
+  virtual bool solve();
+
+  virtual bool hasSolution() const
+  {
+    return _cplex.getStatus() == IloAlgorithm::Feasible
+      || _cplex.getStatus() == IloAlgorithm::Optimal;
+  }
+
+  virtual void getValues(StlDoubleVector& vals) const;
+
+  virtual double getObjValue() const
+  {
+    return _cplex.getObjValue();
+  }
+
+  virtual double getBestObjValue() const
+  {
+    return _cplex.getBestObjValue();
+  }
+
+  virtual void abort()
+  {
+    _aborter.abort();
+  }
+
+  /// Set CPLEX parameters of solver profile
+  ///
+  /// @param cplex CPLEX solver
+  /// @param profile Solver profile
+  static void applyProfile(IloCplex cplex, const SolverProfile& profile);
+
+  /// Convert row to CPLEX range
+  ///
+  /// @param env Environment
+  /// @param vars Variables
+  /// @param row Row
+  static IloRange toRange(IloEnv env,
+                          const IloBoolVarArray& vars,
+                          const Row& row);
+
+private:
+  /// Cplex environment
+  IloEnv _env;
+  /// Cplex model
+  IloModel _model;
+  /// Objective, replaced in place by setObjective
+  IloObjective _obj;
+  /// Cplex solver
+  IloCplex _cplex;
+  /// Aborts solve when triggered
+  IloCplex::Aborter _aborter;
+  /// Variables
+  IloBoolVarArray _vars;
+  /// Deterministic time spent by the last solve
+  double _detTime;
+  /// Incumbent callback, called by a CPLEX incumbent callback
+  IncumbentCallback _incumbentCallback;
+  /// Separation callback, called by CPLEX user cut and lazy constraint callbacks
+  SeparationCallback _separationCallback;
+  /// Serializes the retrieval of values in callbacks
+  IloFastMutex _mutex;
+};
+
+#endif // CPLEXBACKEND_H
@@ -8,388 +8,127 @@
 #ifndef DOLLOCALLBACK_H
 #define DOLLOCALLBACK_H
 
-#include <ilcplex/ilocplex.h>
-#include <ilconcert/ilothread.h>
 #include "utils.h"
+#include "mipbackend.h"
+#include "forbiddenpatterns.h"
 
-template<class T>
-class DolloCallback : public T
+/// This class separates the forbidden submatrices of a k-Dollo completion,
+/// it is used as MipBackend::SeparationCallback of the full ILP
+class DolloCallback
 {
 private:
   const int _m;
   const int _n;
   const int _k;
-  IloBoolVarArray _vars;
-  int _maxIterations;
-  int _currentIterations;
-  IloCplex::MIPCallbackI::NodeId _nodeId;
-  IloFastMutex* _pMutex;
-  
-  int getIndex(int p, int c, int i) const
-  {
-    return (_n * (_k + 2)) * p + (_k + 2) * c + i;
-  }
   
 public:
-  typedef IloArray<IloArray<IloBoolVarArray> > IloBoolVar3Matrix;
-  
-  DolloCallback(IloEnv env,
-                const IloBoolVar3Matrix& E,
-                const int m,
+  DolloCallback(const int m,
                 const int n,
-                const int k,
-                IloFastMutex* pMutex)
-    : T(env)
-    , _m(m)
+                const int k)
+    : _m(m)
     , _n(n)
     , _k(k)
-    , _vars()
-    , _maxIterations(100)
-    , _currentIterations(0)
-    , _nodeId()
-    , _pMutex(pMutex)
-  {
-    _vars = IloBoolVarArray(env, _m * _n * (_k + 2));
-    
-    for (int p = 0; p < _m; ++p)
-    {
-      for (int c = 0; c < _n; ++c)
-      {
-        for (int i = 0; i <= _k + 1; ++i)
-        {
-          _vars[getIndex(p, c, i)] = E[p][c][i];
-        }
-      }
-    }
-  }
-  
-  IloCplex::CallbackI *duplicateCallback() const
   {
-    return (new (T::getEnv()) DolloCallback(*this));
   }
   
-  void main();
+  /// Append violated forbidden submatrix constraints to rows
+  ///
+  /// @param vals Current values of the variables, indexed by
+  /// (n * (k + 2)) * p + (k + 2) * c + i
+  /// @param rows Output rows
+  void operator()(const StlDoubleVector& vals,
+                  MipBackend::RowVector& rows) const;
   
-  void separate();
+  /// Separate forbidden submatrices, for K losses known at compile time or
+  /// K = -1 for the generic case
+  ///
+  /// @param vals Current values of the variables
+  /// @param rows Output rows
+  template<int K>
+  void separate(const StlDoubleVector& vals,
+                MipBackend::RowVector& rows) const;
 };
 
-template<class T>
-void DolloCallback<T>::separate()
+inline void DolloCallback::operator()(const StlDoubleVector& vals,
+                                      MipBackend::RowVector& rows) const
 {
-  IloNumArray vals = IloNumArray(T::getEnv(), _vars.getSize());
-
-  _pMutex->lock();
-  T::getValues(vals, _vars);
-  _pMutex->unlock();
-  
-  for (int c = 0; c < _n; ++c)
+  switch (_k)
   {
-    for (int d = c + 1; d < _n; ++d)
-    {
-      // condition 1
-      for (int j = 2; j <= _k + 1; ++j)
-      {
-        for (int j_prime = 1; j_prime <= _k + 1; ++j_prime)
-        {
-          if (j_prime == j) continue;
-          
-          int p_star = -1;
-          double val_p_star = 0;
-          for (int p = 0; p < _m; p++)
-          {
-            double val = vals[getIndex(p, c, 1)] + vals[getIndex(p, d, j_prime)];
-            if (val > val_p_star)
-            {
-              val_p_star = val;
-              p_star = p;
-            }
-          }
-          
-          int q_star = -1;
-          double val_q_star = 0;
-          for (int q = 0; q < _m; q++)
-          {
-            if (q == p_star) continue;
-            double val = vals[getIndex(q, c, 0)] + vals[getIndex(q, d, j)];
-            if (val > val_q_star)
-            {
-              val_q_star = val;
-              q_star = q;
-            }
-          }
-          
-          int r_star = -1;
-          double val_r_star = 0;
-          for (int r = 0; r < _m; r++)
-          {
-            if (r == p_star) continue;
-            if (r == q_star) continue;
-            double val = vals[getIndex(r, c, 1)] + vals[getIndex(r, d, j)];
-            if (val > val_r_star)
-            {
-              val_r_star = val;
-              r_star = r;
-            }
-          }
-          
-          if (g_tol.less(5., val_p_star + val_q_star + val_r_star))
-          {
-            assert(p_star != q_star);
-            assert(p_star != r_star);
-            assert(q_star != r_star);
-            
-            assert(g_tol.less(5., vals[getIndex(p_star, c, 1)] + vals[getIndex(p_star, d, j_prime)] +
-                              vals[getIndex(q_star, c, 0)] + vals[getIndex(q_star, d, j)] +
-                              vals[getIndex(r_star, c, 1)] + vals[getIndex(r_star, d, j)]));
-            
-            T::add(_vars[getIndex(p_star, c, 1)] + _vars[getIndex(p_star, d, j_prime)] +
-                   _vars[getIndex(q_star, c, 0)] + _vars[getIndex(q_star, d, j)] +
-                   _vars[getIndex(r_star, c, 1)] + _vars[getIndex(r_star, d, j)] <= 5,
-                   IloCplex::UseCutPurge).end();
-          }
-        }
-      }
-      
-      // condition 2
-      for (int i = 2; i <= _k + 1; ++i)
-      {
-        for (int i_prime = 1; i_prime <= _k + 1; ++i_prime)
-        {
-          if (i == i_prime) continue;
-          
-          int p_star = -1;
-          double val_p_star = 0;
-          for (int p = 0; p < _m; p++)
-          {
-            double val = vals[getIndex(p, c, i)] + vals[getIndex(p, d, 0)];
-            if (val > val_p_star)
-            {
-              val_p_star = val;
-              p_star = p;
-            }
-          }
-          
-          int q_star = -1;
-          double val_q_star = 0;
-          for (int q = 0; q < _m; q++)
-          {
-            if (q == p_star) continue;
-            double val = vals[getIndex(q, c, i_prime)] + vals[getIndex(q, d, 1)];
-            if (val > val_q_star)
-            {
-              val_q_star = val;
-              q_star = q;
-            }
-          }
-          
-          int r_star = -1;
-          double val_r_star = 0;
-          for (int r = 0; r < _m; r++)
-          {
-            if (r == p_star) continue;
-            if (r == q_star) continue;
-            double val = vals[getIndex(r, c, i)] + vals[getIndex(r, d, 1)];
-            if (val > val_r_star)
-            {
-              val_r_star = val;
-              r_star = r;
-            }
-          }
-          
-          if (g_tol.less(5., val_p_star + val_q_star + val_r_star))
-          {
-            assert(p_star != q_star);
-            assert(p_star != r_star);
-            assert(q_star != r_star);
-            
-            assert(g_tol.less(5., vals[getIndex(p_star, c, i)] + vals[getIndex(p_star, d, 0)] +
-                              vals[getIndex(q_star, c, i_prime)] + vals[getIndex(q_star, d, 1)] +
-                              vals[getIndex(r_star, c, i)] + vals[getIndex(r_star, d, 1)]));
-            
-            T::add(_vars[getIndex(p_star, c, i)] + _vars[getIndex(p_star, d, 0)] +
-                   _vars[getIndex(q_star, c, i_prime)] + _vars[getIndex(q_star, d, 1)] +
-                   _vars[getIndex(r_star, c, i)] + _vars[getIndex(r_star, d, 1)] <= 5,
-                   IloCplex::UseCutPurge).end();
-          }
-        }
-      }
-      
-      // condition 3
-      for (int i = 2; i <= _k + 1; ++i)
-      {
-        for (int i_prime = 1; i_prime <= _k + 1; ++i_prime)
-        {
-          if (i == i_prime) continue;
-          for (int j = 2; j <= _k + 1; ++j)
-          {
-            for (int j_prime = 1; j_prime <= _k + 1; ++j_prime)
-            {
-              if (j == j_prime) continue;
-              
-              int p_star = -1;
-              double val_p_star = 0;
-              for (int p = 0; p < _m; p++)
-              {
-                double val = vals[getIndex(p, c, i)] + vals[getIndex(p, d, j_prime)];
-                if (val > val_p_star)
-                {
-                  val_p_star = val;
-                  p_star = p;
-                }
-              }
-              
-              int q_star = -1;
-              double val_q_star = 0;
-              for (int q = 0; q < _m; q++)
-              {
-                if (q == p_star) continue;
-                double val = vals[getIndex(q, c, i_prime)] + vals[getIndex(q, d, j)];
-                if (val > val_q_star)
-                {
-                  val_q_star = val;
-                  q_star = q;
-                }
-              }
-              
-              int r_star = -1;
-              double val_r_star = 0;
-              for (int r = 0; r < _m; r++)
-              {
-                if (r == p_star) continue;
-                if (r == q_star) continue;
-                double val = vals[getIndex(r, c, i)] + vals[getIndex(r, d, j)];
-                if (val > val_r_star)
-                {
-                  val_r_star = val;
-                  r_star = r;
-                }
-              }
-              
-              if (g_tol.less(5., val_p_star + val_q_star + val_r_star))
-              {
-                assert(p_star != q_star);
-                assert(p_star != r_star);
-                assert(q_star != r_star);
-                
-                assert(g_tol.less(5., vals[getIndex(p_star, c, i)] + vals[getIndex(p_star, d, j_prime)] +
-                                  vals[getIndex(q_star, c, i_prime)] + vals[getIndex(q_star, d, j)] +
-                                  vals[getIndex(r_star, c, i)] + vals[getIndex(r_star, d, j)]));
-                
-                T::add(_vars[getIndex(p_star, c, i)] + _vars[getIndex(p_star, d, j_prime)] +
-                       _vars[getIndex(q_star, c, i_prime)] + _vars[getIndex(q_star, d, j)] +
-                       _vars[getIndex(r_star, c, i)] + _vars[getIndex(r_star, d, j)] <= 5,
-                       IloCplex::UseCutPurge).end();
-              }
-            }
-          }
-        }
-      }
-      
-      // condition 4
-      for (int i = 1; i <= _k + 1; ++i)
-      {
-        for (int i_prime = 1; i_prime <= _k + 1; ++i_prime)
-        {
-          for (int j = 1; j <= _k + 1; ++j)
-          {
-            for (int j_prime = 1; j_prime <= _k + 1; ++j_prime)
-            {
-              int p_star = -1;
-              double val_p_star = 0;
-              for (int p = 0; p < _m; p++)
-              {
-                double val = vals[getIndex(p, c, i)] + vals[getIndex(p, d, 0)];
-                if (val > val_p_star)
-                {
-                  val_p_star = val;
-                  p_star = p;
-                }
-              }
-              
-              int q_star = -1;
-              double val_q_star = 0;
-              for (int q = 0; q < _m; q++)
-              {
-                if (q == p_star) continue;
-                double val = vals[getIndex(q, c, 0)] + vals[getIndex(q, d, j)];
-                if (val > val_q_star)
-                {
-                  val_q_star = val;
-                  q_star = q;
-                }
-              }
-              
-              int r_star = -1;
-              double val_r_star = 0;
-              for (int r = 0; r < _m; r++)
-              {
-                if (r == p_star) continue;
-                if (r == q_star) continue;
-                double val = vals[getIndex(r, c, i_prime)] + vals[getIndex(r, d, j_prime)];
-                if (val > val_r_star)
-                {
-                  val_r_star = val;
-                  r_star = r;
-                }
-              }
-              
-              if (g_tol.less(5., val_p_star + val_q_star + val_r_star))
-              {
-                assert(p_star != q_star);
-                assert(p_star != r_star);
-                assert(q_star != r_star);
-                assert(g_tol.less(5., vals[getIndex(p_star, c, i)] + vals[getIndex(p_star, d, 0)] +
-                                  vals[getIndex(q_star, c, 0)] + vals[getIndex(q_star, d, j)] +
-                                  vals[getIndex(r_star, c, i_prime)] + vals[getIndex(r_star, d, j_prime)]));
-                
-                T::add(_vars[getIndex(p_star, c, i)] + _vars[getIndex(p_star, d, 0)] +
-                       _vars[getIndex(q_star, c, 0)] + _vars[getIndex(q_star, d, j)] +
-                       _vars[getIndex(r_star, c, i_prime)] + _vars[getIndex(r_star, d, j_prime)] <= 5,
-                       IloCplex::UseCutPurge).end();
-              }
-            }
-          }
-        }
-      }
-    }
+    case 0:
+      separate<0>(vals, rows);
+      break;
+    case 1:
+      separate<1>(vals, rows);
+      break;
+    case 2:
+      separate<2>(vals, rows);
+      break;
+    case 3:
+      separate<3>(vals, rows);
+      break;
+    case 4:
+      separate<4>(vals, rows);
+      break;
+    default:
+      separate<-1>(vals, rows);
+      break;
   }
 }
 
-template<>
-inline void DolloCallback<IloCplex::UserCutCallbackI>::main()
+template<int K>
+inline void DolloCallback::separate(const StlDoubleVector& vals,
+                                    MipBackend::RowVector& rows) const
 {
-  if (_currentIterations == _maxIterations)
-  {
-    abortCutLoop();
-  }
-  
-  IloCplex::MIPCallbackI::NodeId newId = getNodeId();
-  if (_currentIterations == 0 || newId != _nodeId)
-  {
-    _nodeId = newId;
-  }
-  _currentIterations++;
+  const StateIndex<K> index(_n, _k);
   
-  separate();
-}
-
-
-template<class T>
-inline void DolloCallback<T>::main()
-{
-  if (_currentIterations == _maxIterations)
+  // taxon other than excluded1 and excluded2 that maximizes the sum of the
+  // values of state s_c in character c and state s_d in character d
+  auto argMax = [&](int c, int s_c, int d, int s_d,
+                    int excluded1, int excluded2, double& maxVal)
   {
-    return;
-  }
+    int res = -1;
+    maxVal = 0;
+    for (int p = 0; p < _m; p++)
+    {
+      if (p == excluded1 || p == excluded2) continue;
+      double val = vals[index(p, c, s_c)] + vals[index(p, d, s_d)];
+      if (val > maxVal)
+      {
+        maxVal = val;
+        res = p;
+      }
+    }
+    return res;
+  };
   
-  IloCplex::MIPCallbackI::NodeId newId = T::getNodeId();
-  if (_currentIterations == 0 || newId != _nodeId)
+  forEachForbiddenPattern<K>(_k, _n,
+                             [](int, int) { return true; },
+                             [&](int c, int d, const ForbiddenPattern& pattern)
   {
-    _nodeId = newId;
-  }
-  _currentIterations++;
-  
-  separate();
+    double val_p_star, val_q_star, val_r_star;
+    int p_star = argMax(c, pattern._pc, d, pattern._pd, -1, -1, val_p_star);
+    int q_star = argMax(c, pattern._qc, d, pattern._qd, p_star, -1, val_q_star);
+    int r_star = argMax(c, pattern._rc, d, pattern._rd, p_star, q_star, val_r_star);
+    
+    if (g_tol.less(5., val_p_star + val_q_star + val_r_star))
+    {
+      assert(p_star != q_star);
+      assert(p_star != r_star);
+      assert(q_star != r_star);
+      
+      MipBackend::Row row;
+      row._vars = {
+        index(p_star, c, pattern._pc), index(p_star, d, pattern._pd),
+        index(q_star, c, pattern._qc), index(q_star, d, pattern._qd),
+        index(r_star, c, pattern._rc), index(r_star, d, pattern._rd)
+      };
+      row._coefs.assign(6, 1.);
+      row._lb = -MipBackend::INF;
+      row._ub = 5;
+      rows.push_back(row);
+    }
+    return true;
+  });
 }
 
 #endif // DOLLOCALLBACK_H
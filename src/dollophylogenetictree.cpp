@@ -6,13 +6,13 @@
  */
 
 #include "dollophylogenetictree.h"
+#include <unordered_map>
 
 DolloPhylogeneticTree::DolloPhylogeneticTree(const Matrix& A)
   : PhylogeneticTree()
   , _A(A)
   , _B(A.getNrTaxa(), A.getNrCharacters())
   , _Bprime(_A.getNrTaxa(), _A.getNrCharacters() * (_A.getMaxNrLosses() + 1))
-  , _a(_T, StlIntVector(_A.getNrCharacters(), 0))
 {
   const int m = _A.getNrTaxa();
   const int n = _A.getNrCharacters();
@@ -31,7 +31,8 @@ DolloPhylogeneticTree::DolloPhylogeneticTree(const Matrix& A)
   expand();
 }
 
-DolloPhylogeneticTree* DolloPhylogeneticTree::parse(const std::string& filename)
+DolloPhylogeneticTree* DolloPhylogeneticTree::parse(const std::string& filename,
+                                                    int nrThreads)
 {
   Matrix* pMatrix = Matrix::parse(filename);
   if (!pMatrix)
@@ -40,7 +41,7 @@ DolloPhylogeneticTree* DolloPhylogeneticTree::parse(const std::string& filename)
   }
   
   DolloPhylogeneticTree* pTree = new DolloPhylogeneticTree(*pMatrix);
-  if (!pTree->reconstructTree())
+  if (!pTree->reconstructTree(nrThreads))
   {
     std::cerr << "Error: provided matrix '" << filename << "' is not a k-Dollo completion for k = " << pMatrix->getMaxNrLosses() << std::endl;
     delete pMatrix;
@@ -73,7 +74,7 @@ void DolloPhylogeneticTree::expand()
   }
 }
 
-bool DolloPhylogeneticTree::reconstructTree()
+bool DolloPhylogeneticTree::reconstructTree(int nrThreads)
 {
   typedef std::vector<IntPair> IntPairVector;
   
@@ -83,9 +84,12 @@ bool DolloPhylogeneticTree::reconstructTree()
   
   StlBoolVector introducedChar(n, false);
   
+  // only spawn threads for blocks of at least this many matrix entries
+  const int minBlockEntries = 1 << 16;
+  
   // 1. sort columns of Bprime by number of 1s
   IntPairVector columns(n, IntPair(-1, -1));
-  for (int c = 0; c < n; ++c)
+  parallelFor(n, nrThreads, [&](int c)
   {
     int nr1s = 0;
     for (int p = 0; p < m; ++p)
@@ -96,7 +100,7 @@ bool DolloPhylogeneticTree::reconstructTree()
       }
     }
     columns[c] = IntPair(nr1s, c);
-  }
+  }, minBlockEntries / std::max(1, m));
   // Very important to ensure that in the case of ties losses are introduced after gains!!!
   std::sort(columns.begin(), columns.end(),
             [](const IntPair& a, const IntPair& b)
@@ -104,176 +108,144 @@ bool DolloPhylogeneticTree::reconstructTree()
               return a.first > b.first || (a.first == b.first && a.second < b.second);
             });
   
+  // 2. pack every row as the sequence of its 1-columns in sorted order,
+  // i.e. the path of the taxon from the root
+  StlIntMatrix path(m);
+  parallelFor(m, nrThreads, [&](int p)
+  {
+    for (const IntPair& pair : columns)
+    {
+      if (_Bprime.getEntry(p, pair.second) == 1)
+      {
+        path[p].push_back(pair.second);
+      }
+    }
+  }, minBlockEntries / std::max(1, n));
+  
+  // 3. insert paths into the trie, children are looked up by (node, column)
+  std::unordered_map<uint64_t, Node> child;
+  child.reserve(n);
   for (int p = 0; p < m; ++p)
   {
     Node v = _root;
-    for (const IntPair& pair : columns)
+    for (int c : path[p])
     {
-      int c = pair.second;
-
-      IntPair charState;
-      charState.first = getOriginalCharacter(c);
-      charState.second = getOriginalState(c);
-      
-      if (_Bprime.getEntry(p, c) == 1)
+      const uint64_t key = (uint64_t(_T.id(v)) << 32) | uint32_t(c);
+      auto it = child.find(key);
+      if (it != child.end())
+      {
+        v = it->second;
+      }
+      else
       {
-        bool found = false;
+        IntPair charState;
+        charState.first = getOriginalCharacter(c);
+        charState.second = getOriginalState(c);
         
-        for (OutArcIt a(_T, v); a != lemon::INVALID; ++a)
+        Node w = _T.addNode();
+        Arc a = _T.addArc(v, w);
+        _charStateLabeling[a].insert(charState);
+        _charStateVectorLabeling[a].push_back(charState);
+        child[key] = w;
+        v = w;
+        if (introducedChar[c])
         {
-          if (_charStateLabeling[a].count(charState) == 1)
+#ifdef DEBUG
+          for (int cc = 0; cc < _Bprime.getNrCharacters(); ++cc)
           {
-            found = true;
-            v = _T.target(a);
+            std::cout << getOriginalCharacter(cc) << "," << getOriginalState(cc) << " ";
           }
-        }
-        
-        if (!found)
-        {
-          Node w = _T.addNode();
-          Arc a = _T.addArc(v, w);
-          _charStateLabeling[a].insert(charState);
-          _charStateVectorLabeling[a].push_back(charState);
-          v = w;
-          if (introducedChar[c])
+          std::cout << std::endl;
+          for (int pp = 0; pp <= p; ++pp)
           {
-#ifdef DEBUG
             for (int cc = 0; cc < _Bprime.getNrCharacters(); ++cc)
             {
-              std::cout << getOriginalCharacter(cc) << "," << getOriginalState(cc) << " ";
+              std::cout << _Bprime.getEntry(pp, cc) << "  ";
             }
             std::cout << std::endl;
-            for (int pp = 0; pp <= p; ++pp)
-            {
-              for (int cc = 0; cc < _Bprime.getNrCharacters(); ++cc)
-              {
-                std::cout << _Bprime.getEntry(pp, cc) << "  ";
-              }
-              std::cout << std::endl;
-            }
-#endif
-            return false;
-          }
-          else
-          {
-            introducedChar[c] = true;
           }
+#endif
+          return false;
+        }
+        else
+        {
+          introducedChar[c] = true;
         }
       }
     }
+    
     Node v_p = _T.addNode();
     _T.addArc(v, v_p);
     _taxonToLeaf[p] = v_p;
     _leafToTaxon[v_p] = p;
   }
   
-  _a[_root] = StlIntVector(_A.getNrCharacters(), 0);
-  _b[_root] = StlIntVector(_A.getNrCharacters(), 0);
-  
-  labelNodes(_root);
-  StlIntVector problem = _b[_taxonToLeaf[0]];
-  StlIntVector problem2 = _a[_taxonToLeaf[0]];
+  _n = _A.getNrCharacters();
+  _rootState = StlIntVector(_n, 0);
+  computeLeafStates(NULL, &_B);
   
   collapseBranches();
   
   return true;
 }
 
-void DolloPhylogeneticTree::labelNodes(Node v)
+void DolloPhylogeneticTree::generateLosses(double lossRate,
+                                           int k,
+                                           int seed)
 {
-  for (OutArcIt a(_T, v); a != lemon::INVALID; ++a)
+  const int n = _A.getNrCharacters();
+  StlIntVector allowedLosses(n, k);
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<> unif(0., 1.);
+  
+  CsrTree tree;
+  buildCsr(tree);
+  
+  // losses on the outgoing arcs of a node are drawn when the node is visited,
+  // before its children are visited
+  StlIntVector state_w;
+  StlIntVector characters;
+  visitStates(tree, [&](int i, const StlIntVector& state)
   {
-    Node w = _T.target(a);
-    _a[w] = _a[v];
-    _b[w] = _b[v];
-    
-    for (const IntPair& ci : _charStateLabeling[a])
+    for (int idx = tree._offset[i]; idx < tree._offset[i + 1]; ++idx)
     {
-      _a[w][ci.first] = ci.second;
-      if (ci.second >= 2)
+      const int j = tree._child[idx];
+      if (tree.isLeaf(j))
       {
-        _b[w][ci.first] = 0;
+        // no losses on leaves
+        continue;
       }
-      else
+      
+      Arc a = tree._inArc[j];
+      state_w = state;
+      for (const IntPair& ci : _charStateLabeling[a])
       {
-        assert(ci.second == 1);
-        _b[w][ci.first] = 1;
+        state_w[ci.first] = ci.second;
       }
-    }
-    
-    labelNodes(w);
-  }
-}
-
-void DolloPhylogeneticTree::generateLosses(Node v,
-                                           int k,
-                                           double lossRate,
-                                           StlIntVector&  allowedLosses,
-                                           std::mt19937& rng)
-{
-  std::uniform_real_distribution<> unif(0., 1.);
-  const int n = _A.getNrCharacters();
-  
-  for (OutArcIt a(_T, v); a != lemon::INVALID; ++a)
-  {
-    Node w = _T.target(a);
-    if (OutArcIt(_T, w) == lemon::INVALID)
-    {
-      // no losses on leaves
-      continue;
-    }
-
-    // pick a character to lose
-    StlIntVector characters;
-    for (int c = 0; c < n; ++c)
-    {
-      if (_a[w][c] == 1
-          && _charStateLabeling[a].count(IntPair(c, 1)) == 0
-          && allowedLosses[c] > 0)
+      
+      // pick a character to lose
+      characters.clear();
+      for (int c = 0; c < n; ++c)
       {
-        characters.push_back(c);
+        if (state_w[c] == 1
+            && _charStateLabeling[a].count(IntPair(c, 1)) == 0
+            && allowedLosses[c] > 0)
+        {
+          characters.push_back(c);
+        }
       }
-    }
-    for (int c : characters)
-    {
-      double r = unif(rng);
-      if (r <= lossRate)
+      for (int c : characters)
       {
-        _charStateLabeling[a].insert(IntPair(c, k - allowedLosses[c] + 2));
-        --allowedLosses[c];
+        double r = unif(rng);
+        if (r <= lossRate)
+        {
+          _charStateLabeling[a].insert(IntPair(c, k - allowedLosses[c] + 2));
+          --allowedLosses[c];
+        }
       }
     }
-  }
+  });
   
-  labelNodes(v);
-  
-  for (OutArcIt a(_T, v); a != lemon::INVALID; ++a)
-  {
-    Node w = _T.target(a);
-    
-    generateLosses(w, k, lossRate, allowedLosses, rng);
-  }
-}
-
-void DolloPhylogeneticTree::generateLosses(double lossRate,
-                                           int k,
-                                           int seed)
-{
-  StlIntVector allowedLosses(_A.getNrCharacters(), k);
-  std::mt19937 rng(seed);
-  generateLosses(_root, k, lossRate, allowedLosses, rng);
-  
-  // Update E and B
-  const int m = _Bprime.getNrTaxa();
-  const int n = _Bprime.getNrCharacters();
-  
-  for (int p = 0; p < m; ++p)
-  {
-    Node v_p = _taxonToLeaf[p];
-    for (int c = 0; c < n; ++c)
-    {
-      _A.setEntry(p, c, _a[v_p][c]);
-      _B.setEntry(p, c, _b[v_p][c]);
-    }
-  }
+  // Update A and B
+  computeLeafStates(&_A, &_B);
 }
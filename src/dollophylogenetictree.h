@@ -24,10 +24,14 @@ public:
   /// Construct k-Dollo phylogenetic tree from file. Returns NULL if construction fails.
   ///
   /// @param filename Filename
-  static DolloPhylogeneticTree* parse(const std::string& filename);
+  /// @param nrThreads Number of threads used by reconstructTree
+  static DolloPhylogeneticTree* parse(const std::string& filename,
+                                      int nrThreads = 1);
   
   /// Attempts to construct k-Dollo phylogenetic tree from the input k-Dollo completion
-  bool reconstructTree();
+  ///
+  /// @param nrThreads Number of threads used to preprocess the expanded matrix
+  bool reconstructTree(int nrThreads = 1);
   
   /// Introduces character losses
   ///
@@ -42,15 +46,16 @@ public:
     return _A;
   }
   
+  /// Return binary leaf labeling matrix
+  virtual Matrix getMatrixB() const
+  {
+    return _B;
+  }
+  
 private:
   /// Generate binary factor matrix
   void expand();
   
-  /// Label nodes in the subtree rooted at the given node the character states they posses
-  ///
-  /// @param v Node
-  void labelNodes(Node v);
-  
   /// Maps character of binary factor matrix back to original character
   int getOriginalCharacter(int d) const
   {
@@ -77,19 +82,6 @@ private:
     return c * (k + 1) + i - 1;
   }
   
-  /// Introduce losses at the subtree rooted at the given node
-  ///
-  /// @param v Node
-  /// @param k Maximum number of losses per character
-  /// @param lossRate Probability of character loss
-  /// @param allowedLosses Number of remaining losses for each character
-  /// @param rng Random number generator
-  void generateLosses(Node v,
-                      int k,
-                      double lossRate,
-                      StlIntVector& allowedLosses,
-                      std::mt19937& rng);
-  
 private:
   /// Completed matrix
   Matrix _A;
@@ -97,8 +89,6 @@ private:
   Matrix _B;
   /// Binary expansion of _A
   Matrix _Bprime;
-  /// Node label (state vectors)
-  IntVectorNodeMap _a;
 };
 
 #endif // PHYLOGENETICTREE_H
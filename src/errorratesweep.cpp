@@ -0,0 +1,145 @@
+/*
+ * errorratesweep.cpp
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#include "errorratesweep.h"
+#include <sstream>
+
+ErrorRateSweep::ErrorRateSweep(ColumnGenFlip& solver,
+                               const Matrix& D,
+                               const StlIntVector& characterMapping,
+                               const StlIntVector& taxonMapping,
+                               const StlDoubleVector& alphas,
+                               const StlDoubleVector& betas)
+  : _solver(solver)
+  , _D(D)
+  , _characterMapping(characterMapping)
+  , _taxonMapping(taxonMapping)
+  , _alphas(alphas)
+  , _betas(betas)
+  , _results()
+{
+}
+
+bool ErrorRateSweep::solve(int timeLimit,
+                           int memoryLimit,
+                           int nrThreads,
+                           bool verbose)
+{
+  const int nrAlphas = _alphas.size();
+  const int nrBetas = _betas.size();
+  
+  _results.clear();
+  _results.resize(nrAlphas * nrBetas);
+  for (int i = 0; i < nrAlphas; ++i)
+  {
+    for (int j = 0; j < nrBetas; ++j)
+    {
+      Result& result = _results[i * nrBetas + j];
+      result._alpha = _alphas[i];
+      result._beta = _betas[j];
+      result._solved = false;
+    }
+  }
+  
+  bool first = true;
+  for (int i = 0; i < nrAlphas; ++i)
+  {
+    for (int jj = 0; jj < nrBetas; ++jj)
+    {
+      const int j = i % 2 == 0 ? jj : nrBetas - 1 - jj;
+      Result& result = _results[i * nrBetas + j];
+      
+      std::cerr << "Solving alpha = " << result._alpha
+                << ", beta = " << result._beta << std::endl;
+      double startTime = g_timer.realTime();
+      
+      _solver.setErrorRates(result._alpha, result._beta);
+      if (!first)
+      {
+        // the previous optimum satisfies all separated constraints
+        _solver.initHotStart(_solver.getSolA());
+      }
+      first = false;
+      
+      result._solved = _solver.solve(timeLimit, memoryLimit, nrThreads, verbose);
+      result._time = g_timer.realTime() - startTime;
+      if (!result._solved)
+      {
+        return false;
+      }
+      
+      Matrix A = _solver.getSolA().expand(_characterMapping, _taxonMapping);
+      result._objValue = _solver.getObjValue();
+      result._logLikelihood = ColumnGenFlip::getLogLikelihood(_D, A,
+                                                              result._alpha,
+                                                              result._beta);
+      result._nrFlips01 = result._nrFlips10 = 0;
+      for (int p = 0; p < _D.getNrTaxa(); ++p)
+      {
+        for (int c = 0; c < _D.getNrCharacters(); ++c)
+        {
+          int d_pc = _D.getEntry(p, c);
+          int a_pc = A.getEntry(p, c) == 1 ? 1 : 0;
+          if (d_pc == 0 && a_pc == 1)
+          {
+            ++result._nrFlips01;
+          }
+          else if (d_pc == 1 && a_pc == 0)
+          {
+            ++result._nrFlips10;
+          }
+        }
+      }
+    }
+  }
+  
+  return true;
+}
+
+void ErrorRateSweep::writeTable(std::ostream& out) const
+{
+  out << "alpha,beta,objective,log_likelihood,flips01,flips10,time" << std::endl;
+  for (const Result& result : _results)
+  {
+    if (!result._solved)
+      continue;
+    
+    out << result._alpha << ","
+        << result._beta << ","
+        << result._objValue << ","
+        << result._logLikelihood << ","
+        << result._nrFlips01 << ","
+        << result._nrFlips10 << ","
+        << result._time << std::endl;
+  }
+}
+
+bool ErrorRateSweep::parseRates(const std::string& str, StlDoubleVector& rates)
+{
+  rates.clear();
+  
+  std::stringstream ss(str);
+  std::string token;
+  while (std::getline(ss, token, ','))
+  {
+    try
+    {
+      double rate = std::stod(token);
+      if (!(0 < rate && rate < 1))
+      {
+        return false;
+      }
+      rates.push_back(rate);
+    }
+    catch (std::logic_error&)
+    {
+      return false;
+    }
+  }
+  
+  return !rates.empty();
+}
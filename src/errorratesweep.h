@@ -0,0 +1,112 @@
+/*
+ * errorratesweep.h
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#ifndef ERRORRATESWEEP_H
+#define ERRORRATESWEEP_H
+
+#include "utils.h"
+#include "matrix.h"
+#include "columngenflip.h"
+
+/// This class solves the k-DPF problem for a grid of error rates using a
+/// single column generation model.
+///
+/// The error rates only appear in the objective function, so the separated
+/// forbidden submatrices and active variables are kept between grid points.
+/// The grid is traversed in serpentine order, i.e. the false negative rates
+/// are visited in alternating direction, so that each grid point is warm
+/// started with the optimal completion of a neighbouring grid point.
+class ErrorRateSweep
+{
+public:
+  /// Result for a single grid point
+  struct Result
+  {
+    /// False positive rate
+    double _alpha;
+    /// False negative rate
+    double _beta;
+    /// Indicates whether the solver succeeded
+    bool _solved;
+    /// Objective value
+    double _objValue;
+    /// Log likelihood of the input matrix given the expanded completion,
+    /// under the error model of the objective function
+    double _logLikelihood;
+    /// Number of flipped entries from 0 to 1
+    int _nrFlips01;
+    /// Number of flipped entries from 1 to 0
+    int _nrFlips10;
+    /// Wall time in seconds
+    double _time;
+  };
+  
+  typedef std::vector<Result> ResultVector;
+  
+  /// Constructor
+  ///
+  /// @param solver Initialized solver
+  /// @param D Input matrix prior to simplification
+  /// @param characterMapping Character mapping of the simplified matrix
+  /// @param taxonMapping Taxon mapping of the simplified matrix
+  /// @param alphas False positive rates
+  /// @param betas False negative rates
+  ErrorRateSweep(ColumnGenFlip& solver,
+                 const Matrix& D,
+                 const StlIntVector& characterMapping,
+                 const StlIntVector& taxonMapping,
+                 const StlDoubleVector& alphas,
+                 const StlDoubleVector& betas);
+  
+  /// Solve every grid point, stops at the first failure. Returns true if all
+  /// grid points were solved.
+  ///
+  /// @param timeLimit Time limit in seconds
+  /// @param memoryLimit Memory limit in megabytes
+  /// @param nrThreads Number of threads the solver can use
+  /// @param verbose Set to true to enable ILP solver output
+  bool solve(int timeLimit,
+             int memoryLimit,
+             int nrThreads,
+             bool verbose);
+  
+  /// Return results in order of the grid, alpha major
+  const ResultVector& getResults() const
+  {
+    return _results;
+  }
+  
+  /// Write comma-separated likelihood table of the solved grid points in
+  /// order of the grid, alpha major
+  ///
+  /// @param out Output stream
+  void writeTable(std::ostream& out) const;
+  
+  /// Parse comma-separated list of rates in (0, 1), returns false if invalid
+  ///
+  /// @param str List
+  /// @param rates Rates
+  static bool parseRates(const std::string& str, StlDoubleVector& rates);
+  
+private:
+  /// Solver
+  ColumnGenFlip& _solver;
+  /// Input matrix prior to simplification
+  const Matrix& _D;
+  /// Character mapping of the simplified matrix
+  const StlIntVector& _characterMapping;
+  /// Taxon mapping of the simplified matrix
+  const StlIntVector& _taxonMapping;
+  /// False positive rates
+  const StlDoubleVector _alphas;
+  /// False negative rates
+  const StlDoubleVector _betas;
+  /// Results
+  ResultVector _results;
+};
+
+#endif // ERRORRATESWEEP_H
@@ -0,0 +1,396 @@
+/*
+ * forbiddenpatterns.h
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#ifndef FORBIDDENPATTERNS_H
+#define FORBIDDENPATTERNS_H
+
+#include <vector>
+#include <cassert>
+
+/// Forbidden 3x2 submatrix of a k-Dollo completion: taxa p, q and r may not
+/// have the given states in characters c and d (with c < d).
+///
+/// The four conditions, with 1 <= i, i', j, j' <= k + 1, are:
+/// 1. (i, 0), (0, j), (i', j')
+/// 2. (i, j'), (0, j), (i', j) with j >= 2 and j' != j
+/// 3. (i, 0), (i', j), (i, j') with i >= 2 and i' != i
+/// 4. (i, j'), (i', j), (i, j) with i, j >= 2, i' != i and j' != j
+struct ForbiddenPattern
+{
+  /// Condition
+  int _condition;
+  /// State of taxon p in character c
+  int _pc;
+  /// State of taxon p in character d
+  int _pd;
+  /// State of taxon q in character c
+  int _qc;
+  /// State of taxon q in character d
+  int _qd;
+  /// State of taxon r in character c
+  int _rc;
+  /// State of taxon r in character d
+  int _rd;
+};
+
+/// Return number of forbidden patterns of the given condition
+///
+/// @param k Maximum number of losses per character
+/// @param condition Condition
+constexpr int getNrForbiddenPatterns(int k, int condition)
+{
+  return condition == 1 ? (k + 1) * (k + 1) * (k + 1) * (k + 1)
+    : condition == 4 ? k * k * k * k
+    : (k + 1) * (k + 1) * k * k;
+}
+
+/// Return number of forbidden patterns
+///
+/// @param k Maximum number of losses per character
+constexpr int getNrForbiddenPatterns(int k)
+{
+  return getNrForbiddenPatterns(k, 1) + getNrForbiddenPatterns(k, 2)
+    + getNrForbiddenPatterns(k, 3) + getNrForbiddenPatterns(k, 4);
+}
+
+/// Return the t-th state in [1, k + 1] \ {excluded}, with 0 <= t < k
+///
+/// @param t Index
+/// @param excluded Excluded state
+constexpr int getStateExcluding(int t, int excluded)
+{
+  return t + 1 < excluded ? t + 1 : t + 2;
+}
+
+/// Return forbidden pattern of the given condition and states
+///
+/// @param condition Condition
+/// @param i State i
+/// @param i_prime State i'
+/// @param j State j
+/// @param j_prime State j'
+constexpr ForbiddenPattern makeForbiddenPattern(int condition,
+                                                int i, int i_prime,
+                                                int j, int j_prime)
+{
+  return condition == 1 ? ForbiddenPattern{1, i, 0, 0, j, i_prime, j_prime}
+    : condition == 2 ? ForbiddenPattern{2, i, j_prime, 0, j, i_prime, j}
+    : condition == 3 ? ForbiddenPattern{3, i, 0, i_prime, j, i, j_prime}
+    : ForbiddenPattern{4, i, j_prime, i_prime, j, i, j};
+}
+
+/// Return idx-th forbidden pattern of the given condition, patterns are
+/// ordered lexicographically by (i, i', j, j')
+///
+/// @param k Maximum number of losses per character
+/// @param condition Condition
+/// @param idx Index
+constexpr ForbiddenPattern getForbiddenPattern(int k, int condition, int idx)
+{
+  return condition == 1
+    ? makeForbiddenPattern(1,
+                           1 + idx / ((k + 1) * (k + 1) * (k + 1)),
+                           1 + idx / ((k + 1) * (k + 1)) % (k + 1),
+                           1 + idx / (k + 1) % (k + 1),
+                           1 + idx % (k + 1))
+    : condition == 2
+    ? makeForbiddenPattern(2,
+                           1 + idx / ((k + 1) * k * k),
+                           1 + idx / (k * k) % (k + 1),
+                           2 + idx / k % k,
+                           getStateExcluding(idx % k, 2 + idx / k % k))
+    : condition == 3
+    ? makeForbiddenPattern(3,
+                           2 + idx / (k * (k + 1) * (k + 1)),
+                           getStateExcluding(idx / ((k + 1) * (k + 1)) % k,
+                                             2 + idx / (k * (k + 1) * (k + 1))),
+                           1 + idx / (k + 1) % (k + 1),
+                           1 + idx % (k + 1))
+    : makeForbiddenPattern(4,
+                           2 + idx / (k * k * k),
+                           getStateExcluding(idx / (k * k) % k, 2 + idx / (k * k * k)),
+                           2 + idx / k % k,
+                           getStateExcluding(idx % k, 2 + idx / k % k));
+}
+
+/// Return idx-th forbidden pattern, patterns are ordered by condition
+///
+/// @param k Maximum number of losses per character
+/// @param idx Index
+constexpr ForbiddenPattern getForbiddenPattern(int k, int idx)
+{
+  return idx < getNrForbiddenPatterns(k, 1)
+    ? getForbiddenPattern(k, 1, idx)
+    : idx < getNrForbiddenPatterns(k, 1) + getNrForbiddenPatterns(k, 2)
+    ? getForbiddenPattern(k, 2, idx - getNrForbiddenPatterns(k, 1))
+    : idx < getNrForbiddenPatterns(k, 1) + getNrForbiddenPatterns(k, 2) + getNrForbiddenPatterns(k, 3)
+    ? getForbiddenPattern(k, 3, idx - getNrForbiddenPatterns(k, 1) - getNrForbiddenPatterns(k, 2))
+    : getForbiddenPattern(k, 4, idx - getNrForbiddenPatterns(k, 1) - getNrForbiddenPatterns(k, 2)
+                                     - getNrForbiddenPatterns(k, 3));
+}
+
+/// Compile-time sequence of indices
+template<int... Is>
+struct IndexSequence
+{
+};
+
+/// Concatenation of two index sequences, the second one shifted
+template<class S1, class S2>
+struct ConcatIndexSequence;
+
+template<int... I1, int... I2>
+struct ConcatIndexSequence<IndexSequence<I1...>, IndexSequence<I2...> >
+{
+  typedef IndexSequence<I1..., (int)sizeof...(I1) + I2...> Type;
+};
+
+/// Index sequence 0, ..., N - 1, generated with logarithmic recursion depth
+template<int N>
+struct MakeIndexSequence
+{
+  typedef typename ConcatIndexSequence<typename MakeIndexSequence<N / 2>::Type,
+                                       typename MakeIndexSequence<N - N / 2>::Type>::Type Type;
+};
+
+template<>
+struct MakeIndexSequence<0>
+{
+  typedef IndexSequence<> Type;
+};
+
+template<>
+struct MakeIndexSequence<1>
+{
+  typedef IndexSequence<0> Type;
+};
+
+/// Compile-time table of forbidden patterns
+template<int K, class S = typename MakeIndexSequence<getNrForbiddenPatterns(K)>::Type>
+struct ForbiddenPatterns;
+
+template<int K, int... Is>
+struct ForbiddenPatterns<K, IndexSequence<Is...> >
+{
+  /// Number of forbidden patterns
+  static constexpr int SIZE = sizeof...(Is);
+  /// Forbidden patterns
+  static constexpr ForbiddenPattern _table[SIZE] = { getForbiddenPattern(K, Is)... };
+};
+
+template<int K, int... Is>
+constexpr ForbiddenPattern ForbiddenPatterns<K, IndexSequence<Is...> >::_table[];
+
+/// Return forbidden patterns for a maximum number of losses that is only
+/// known at run time
+///
+/// @param k Maximum number of losses per character
+inline std::vector<ForbiddenPattern> getForbiddenPatterns(int k)
+{
+  std::vector<ForbiddenPattern> patterns;
+  for (int idx = 0; idx < getNrForbiddenPatterns(k); ++idx)
+  {
+    patterns.push_back(getForbiddenPattern(k, idx));
+  }
+  return patterns;
+}
+
+/// Maximum number of losses for which kernels are specialized at compile time
+const int MAX_SPECIALIZED_K = 4;
+
+/// Forbidden patterns for K losses. K < 0 selects the generic table for a
+/// number of losses that is only known at run time.
+template<int K>
+class ForbiddenPatternTable
+{
+public:
+  /// Constructor
+  ///
+  /// @param k Maximum number of losses per character, equals K
+  explicit ForbiddenPatternTable(int k)
+  {
+    assert(k == K);
+  }
+  
+  /// Return number of forbidden patterns
+  static constexpr int size()
+  {
+    return ForbiddenPatterns<K>::SIZE;
+  }
+  
+  /// Return forbidden pattern
+  ///
+  /// @param idx Index
+  const ForbiddenPattern& operator[](int idx) const
+  {
+    return ForbiddenPatterns<K>::_table[idx];
+  }
+};
+
+template<>
+class ForbiddenPatternTable<-1>
+{
+public:
+  /// Constructor
+  ///
+  /// @param k Maximum number of losses per character
+  explicit ForbiddenPatternTable(int k)
+    : _patterns(getForbiddenPatterns(k))
+  {
+  }
+  
+  /// Return number of forbidden patterns
+  int size() const
+  {
+    return _patterns.size();
+  }
+  
+  /// Return forbidden pattern
+  ///
+  /// @param idx Index
+  const ForbiddenPattern& operator[](int idx) const
+  {
+    return _patterns[idx];
+  }
+  
+private:
+  /// Forbidden patterns
+  const std::vector<ForbiddenPattern> _patterns;
+};
+
+/// Index of the variable indicating that entry (p, c) has state i, with
+/// states 0, ..., k + 1. For K >= 0 the strides are compile-time constants,
+/// K < 0 uses the run-time k.
+template<int K>
+class StateIndex
+{
+public:
+  /// Constructor
+  ///
+  /// @param n Number of characters
+  /// @param k Maximum number of losses per character, equals K
+  StateIndex(int n, int k)
+    : _taxonStride(n * (K + 2))
+  {
+    assert(k == K);
+  }
+  
+  /// Return index
+  ///
+  /// @param p Taxon
+  /// @param c Character
+  /// @param i State
+  int operator()(int p, int c, int i) const
+  {
+    return _taxonStride * p + (K + 2) * c + i;
+  }
+  
+private:
+  /// Number of variables per taxon
+  const int _taxonStride;
+};
+
+template<>
+class StateIndex<-1>
+{
+public:
+  /// Constructor
+  ///
+  /// @param n Number of characters
+  /// @param k Maximum number of losses per character
+  StateIndex(int n, int k)
+    : _taxonStride(n * (k + 2))
+    , _characterStride(k + 2)
+  {
+  }
+  
+  /// Return index
+  ///
+  /// @param p Taxon
+  /// @param c Character
+  /// @param i State
+  int operator()(int p, int c, int i) const
+  {
+    return _taxonStride * p + _characterStride * c + i;
+  }
+  
+private:
+  /// Number of variables per taxon
+  const int _taxonStride;
+  /// Number of variables per entry
+  const int _characterStride;
+};
+
+/// Generic kernel driving all forbidden submatrix checkers and separators.
+/// Calls pairFunc(c, d) for every pair of characters c < d, followed by
+/// patternFunc(c, d, pattern) for every forbidden pattern of k losses. For
+/// K >= 0 the pattern loop has a compile-time trip count and can be
+/// unrolled, K < 0 is the generic fallback. Returns false as soon as either
+/// function returns false.
+///
+/// @param k Maximum number of losses per character
+/// @param n Number of characters
+/// @param pairFunc Function called for each character pair
+/// @param patternFunc Function called for each character pair and pattern
+template<int K, typename PairFunc, typename PatternFunc>
+bool forEachForbiddenPattern(int k,
+                             int n,
+                             PairFunc pairFunc,
+                             PatternFunc patternFunc)
+{
+  const ForbiddenPatternTable<K> patterns(k);
+  for (int c = 0; c < n; ++c)
+  {
+    for (int d = c + 1; d < n; ++d)
+    {
+      if (!pairFunc(c, d))
+      {
+        return false;
+      }
+      for (int idx = 0; idx < patterns.size(); ++idx)
+      {
+        if (!patternFunc(c, d, patterns[idx]))
+        {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+/// Run-time dispatcher of forEachForbiddenPattern, specialized for
+/// k <= MAX_SPECIALIZED_K
+///
+/// @param k Maximum number of losses per character
+/// @param n Number of characters
+/// @param pairFunc Function called for each character pair
+/// @param patternFunc Function called for each character pair and pattern
+template<typename PairFunc, typename PatternFunc>
+bool forEachForbiddenPattern(int k,
+                             int n,
+                             PairFunc pairFunc,
+                             PatternFunc patternFunc)
+{
+  switch (k)
+  {
+    case 0:
+      return forEachForbiddenPattern<0>(k, n, pairFunc, patternFunc);
+    case 1:
+      return forEachForbiddenPattern<1>(k, n, pairFunc, patternFunc);
+    case 2:
+      return forEachForbiddenPattern<2>(k, n, pairFunc, patternFunc);
+    case 3:
+      return forEachForbiddenPattern<3>(k, n, pairFunc, patternFunc);
+    case 4:
+      return forEachForbiddenPattern<4>(k, n, pairFunc, patternFunc);
+    default:
+      return forEachForbiddenPattern<-1>(k, n, pairFunc, patternFunc);
+  }
+}
+
+#endif // FORBIDDENPATTERNS_H
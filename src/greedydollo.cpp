@@ -0,0 +1,146 @@
+/*
+ * greedydollo.cpp
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#include "greedydollo.h"
+#include <boost/dynamic_bitset.hpp>
+
+GreedyDollo::GreedyDollo(const Matrix& D,
+                         int k)
+  : _D(D)
+  , _k(k)
+  , _order()
+  , _parent()
+  , _placement(D.getNrTaxa(), -1)
+  , _solA(D.getNrTaxa(), D.getNrCharacters())
+  , _nrFlips(0)
+{
+}
+
+void GreedyDollo::solve()
+{
+  const int m = _D.getNrTaxa();
+  
+  buildCharacterTree();
+  for (int p = 0; p < m; ++p)
+  {
+    placeTaxon(p);
+  }
+  placeLosses();
+}
+
+void GreedyDollo::buildCharacterTree()
+{
+  typedef boost::dynamic_bitset<> Bitset;
+  
+  const int m = _D.getNrTaxa();
+  const int n = _D.getNrCharacters();
+  
+  // missing entries are treated as zeros
+  std::vector<Bitset> ones(n, Bitset(m));
+  StlIntVector count(n, 0);
+  for (int p = 0; p < m; ++p)
+  {
+    for (int c = 0; c < n; ++c)
+    {
+      if (_D.getEntry(p, c) == 1)
+      {
+        ones[c].set(p);
+        ++count[c];
+      }
+    }
+  }
+  
+  _order = StlIntVector(n);
+  for (int c = 0; c < n; ++c)
+  {
+    _order[c] = c;
+  }
+  std::stable_sort(_order.begin(), _order.end(),
+                   [&count](int c, int d) { return count[c] > count[d]; });
+  
+  // among the characters with maximum overlap pick the one placed last,
+  // which for nested characters is the smallest superset
+  _parent = StlIntVector(n, -1);
+  for (int i = 1; i < n; ++i)
+  {
+    const int c = _order[i];
+    size_t maxOverlap = 0;
+    for (int j = 0; j < i; ++j)
+    {
+      const int d = _order[j];
+      size_t overlap = (ones[c] & ones[d]).count();
+      if (overlap > 0 && overlap >= maxOverlap)
+      {
+        maxOverlap = overlap;
+        _parent[c] = d;
+      }
+    }
+  }
+}
+
+void GreedyDollo::placeTaxon(int p)
+{
+  const int n = _D.getNrCharacters();
+  
+  // cost[c] is the number of flips when p is placed at character c,
+  // placing p at the root flips all observed ones
+  int rootCost = 0;
+  for (int c = 0; c < n; ++c)
+  {
+    if (_D.getEntry(p, c) == 1)
+    {
+      ++rootCost;
+    }
+  }
+  
+  StlIntVector cost(n);
+  int bestCost = rootCost;
+  int best = -1;
+  for (int c : _order)
+  {
+    const int d_pc = _D.getEntry(p, c);
+    const int delta = d_pc == 0 ? 1 : (d_pc == 1 ? -1 : 0);
+    cost[c] = (_parent[c] == -1 ? rootCost : cost[_parent[c]]) + delta;
+    if (cost[c] < bestCost)
+    {
+      bestCost = cost[c];
+      best = c;
+    }
+  }
+  
+  for (int c = 0; c < n; ++c)
+  {
+    _solA.setEntry(p, c, 0);
+  }
+  _placement[p] = best;
+  for (int c = best; c != -1; c = _parent[c])
+  {
+    _solA.setEntry(p, c, 1);
+  }
+  _nrFlips += bestCost;
+}
+
+void GreedyDollo::placeLosses()
+{
+  const int m = _D.getNrTaxa();
+  const int n = _D.getNrCharacters();
+  
+  // each loss occurs on a distinct leaf edge and thus gets its own state
+  for (int c = 0; c < n; ++c)
+  {
+    int nrLosses = 0;
+    for (int p = 0; p < m && nrLosses < _k; ++p)
+    {
+      if (_solA.getEntry(p, c) == 1 && _D.getEntry(p, c) == 0)
+      {
+        _solA.setEntry(p, c, 2 + nrLosses);
+        ++nrLosses;
+        --_nrFlips;
+      }
+    }
+  }
+}
@@ -0,0 +1,89 @@
+/*
+ * greedydollo.h
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#ifndef GREEDYDOLLO_H
+#define GREEDYDOLLO_H
+
+#include "utils.h"
+#include "matrix.h"
+
+/// This class provides a fast combinatorial heuristic for the k-DPF problem.
+///
+/// Characters are sorted by decreasing number of ones and each character is
+/// attached below the previously placed character whose ones it overlaps most,
+/// yielding a perfect phylogeny on the characters. Each taxon is then placed at
+/// the node that minimizes the number of flipped entries, after which up to k
+/// losses per character are placed on leaf edges to repair false negatives.
+/// The resulting completion is a k-Dollo phylogeny that can be used as a MIP
+/// start.
+class GreedyDollo
+{
+public:
+  /// Constructor
+  ///
+  /// @param D Input matrix
+  /// @param k Maximum number of losses per character
+  GreedyDollo(const Matrix& D,
+              int k);
+  
+  /// Construct completion
+  void solve();
+  
+  /// Return solution matrix
+  const Matrix& getSolA() const
+  {
+    return _solA;
+  }
+  
+  /// Return number of observed entries of the input matrix that are flipped
+  int getNrFlips() const
+  {
+    return _nrFlips;
+  }
+  
+  /// Return parent of each character in the character tree, -1 for root
+  const StlIntVector& getCharacterParent() const
+  {
+    return _parent;
+  }
+  
+  /// Return character tree node of each taxon, -1 for root
+  const StlIntVector& getTaxonPlacement() const
+  {
+    return _placement;
+  }
+  
+private:
+  /// Attach each character to its parent in the character tree
+  void buildCharacterTree();
+  
+  /// Place taxon at node of character tree that minimizes number of flips
+  ///
+  /// @param p Taxon
+  void placeTaxon(int p);
+  
+  /// Introduce losses at leaf edges for ones that are observed as zeros
+  void placeLosses();
+  
+private:
+  /// Input matrix
+  const Matrix& _D;
+  /// Maximum number of losses per character
+  const int _k;
+  /// Characters sorted by decreasing number of ones
+  StlIntVector _order;
+  /// Parent of each character in the character tree, -1 for root
+  StlIntVector _parent;
+  /// Character tree node of each taxon, -1 for root
+  StlIntVector _placement;
+  /// Solution matrix
+  Matrix _solA;
+  /// Number of flipped entries
+  int _nrFlips;
+};
+
+#endif // GREEDYDOLLO_H
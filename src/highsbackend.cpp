@@ -0,0 +1,214 @@
+/*
+ * highsbackend.cpp
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#include "highsbackend.h"
+#include <chrono>
+
+HighsBackend::HighsBackend()
+  : _highs()
+  , _aborted(false)
+  , _timeLimit(-1)
+  , _feasible(false)
+  , _incumbentCallback()
+  , _separationCallback()
+  , _mutex()
+  , _pendingRows()
+{
+  _highs.setCallback([](int callbackType, const std::string&,
+                        const HighsCallbackDataOut* dataOut,
+                        HighsCallbackDataIn* dataIn,
+                        void* userData)
+  {
+    static_cast<HighsBackend*>(userData)->callback(callbackType, dataOut, dataIn);
+  }, this);
+  _highs.startCallback(HighsCallbackType::kCallbackMipInterrupt);
+  _highs.startCallback(HighsCallbackType::kCallbackMipImprovingSolution);
+}
+
+void HighsBackend::callback(int callbackType,
+                            const HighsCallbackDataOut* dataOut,
+                            HighsCallbackDataIn* dataIn)
+{
+  if (callbackType == HighsCallbackType::kCallbackMipInterrupt)
+  {
+    // interrupt branch and bound once abort() has been called
+    if (_aborted)
+    {
+      dataIn->user_interrupt = true;
+    }
+  }
+  else if (callbackType == HighsCallbackType::kCallbackMipImprovingSolution)
+  {
+    if (!_incumbentCallback && !_separationCallback)
+      return;
+    
+    StlDoubleVector vals(dataOut->mip_solution,
+                         dataOut->mip_solution + _highs.getNumCol());
+    if (_separationCallback)
+    {
+      // solutions violating separated rows are not incumbents of the full
+      // model, their rows are added before the next re-solve
+      RowVector rows;
+      _separationCallback(vals, rows);
+      if (!rows.empty())
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _pendingRows.insert(_pendingRows.end(), rows.begin(), rows.end());
+        return;
+      }
+    }
+    if (_incumbentCallback)
+    {
+      _incumbentCallback(vals);
+    }
+  }
+}
+
+int HighsBackend::addBinaryVariable(const std::string& name)
+{
+  const HighsInt var = _highs.getNumCol();
+  _highs.addCol(0, 0, 1, 0, NULL, NULL);
+  _highs.changeColIntegrality(var, HighsVarType::kInteger);
+  _highs.passColName(var, name);
+  return var;
+}
+
+void HighsBackend::setUpperBound(int var, double ub)
+{
+  _highs.changeColBounds(var, 0, ub);
+}
+
+void HighsBackend::addRow(const Row& row)
+{
+  std::vector<HighsInt> vars(row._vars.begin(), row._vars.end());
+  _highs.addRow(row._lb, row._ub, vars.size(), vars.data(), row._coefs.data());
+}
+
+void HighsBackend::addLazyRows(const RowVector& rows)
+{
+  for (const Row& row : rows)
+  {
+    addRow(row);
+  }
+}
+
+void HighsBackend::setObjective(const StlDoubleVector& coefs,
+                                double constant,
+                                bool maximize)
+{
+  for (size_t idx = 0; idx < coefs.size(); ++idx)
+  {
+    _highs.changeColCost(idx, coefs[idx]);
+  }
+  _highs.changeObjectiveOffset(constant);
+  _highs.changeObjectiveSense(maximize ? ObjSense::kMaximize : ObjSense::kMinimize);
+}
+
+void HighsBackend::addMIPStart(const StlIntVector& vars,
+                               const StlDoubleVector& vals)
+{
+  HighsSolution solution;
+  solution.col_value.assign(_highs.getNumCol(), 0);
+  for (size_t idx = 0; idx < vars.size(); ++idx)
+  {
+    solution.col_value[vars[idx]] = vals[idx];
+  }
+  solution.value_valid = true;
+  _highs.setSolution(solution);
+}
+
+void HighsBackend::setParameters(int timeLimit,
+                                 int memoryLimit,
+                                 int nrThreads,
+                                 bool verbose)
+{
+  _highs.setOptionValue("output_flag", verbose);
+  if (nrThreads > 0)
+  {
+    _highs.setOptionValue("threads", nrThreads);
+  }
+  // the time limit applies to all re-solves together and is set by solve()
+  _timeLimit = timeLimit;
+}
+
+void HighsBackend::setProfile(const SolverProfile& profile)
+{
+  // HiGHS has no counterpart of emphasis, cut, probing and branching settings
+  if (profile.hasParam("heuristicfreq"))
+  {
+    const double freq = profile.getParam("heuristicfreq");
+    _highs.setOptionValue("mip_heuristic_effort", freq < 0 ? 0. : 0.05);
+  }
+  if (profile.hasParam("mipgap"))
+  {
+    _highs.setOptionValue("mip_rel_gap", profile.getParam("mipgap"));
+  }
+}
+
+bool HighsBackend::solve()
+{
+  // abort() is sticky, like the aborter of CplexBackend, so that an abort
+  // issued before or between solves is not lost
+  _feasible = false;
+  
+  const auto startTime = std::chrono::steady_clock::now();
+  while (true)
+  {
+    if (_aborted)
+    {
+      return false;
+    }
+    if (_timeLimit > 0)
+    {
+      const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+      if (elapsed >= _timeLimit)
+      {
+        return false;
+      }
+      _highs.setOptionValue("time_limit", _timeLimit - elapsed);
+    }
+    
+    _highs.run();
+    const bool optimal = _highs.getModelStatus() == HighsModelStatus::kOptimal;
+    if (_highs.getInfo().primal_solution_status != kSolutionStatusFeasible)
+    {
+      return false;
+    }
+    
+    RowVector rows;
+    if (_separationCallback)
+    {
+      _separationCallback(_highs.getSolution().col_value, rows);
+    }
+    const bool violated = !rows.empty();
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      rows.insert(rows.end(), _pendingRows.begin(), _pendingRows.end());
+      _pendingRows.clear();
+    }
+    for (const Row& row : rows)
+    {
+      addRow(row);
+    }
+    
+    if (!violated)
+    {
+      _feasible = true;
+      return optimal;
+    }
+    if (!optimal)
+    {
+      // the solution violates a separated row and there is no time to re-solve
+      return false;
+    }
+  }
+}
+
+void HighsBackend::getValues(StlDoubleVector& vals) const
+{
+  vals = _highs.getSolution().col_value;
+}
@@ -0,0 +1,132 @@
+/*
+ * highsbackend.h
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#ifndef HIGHSBACKEND_H
+#define HIGHSBACKEND_H
+
+#include <Highs.h>
+#include <atomic>
+#include <mutex>
+#include "mipbackend.h"
+
+/// This class implements the MIP backend using HiGHS. HiGHS has no lazy
+/// constraint pool and no memory limit, lazy rows are added to the model and
+/// the memory limit is ignored. HiGHS cannot add rows during branch and
+/// bound either, so separated rows are added by re-solving the model until
+/// its solution violates none of them.
+class HighsBackend : public MipBackend
+{
+public:
+  /// Constructor
+  HighsBackend();
+
+  virtual int addBinaryVariable(const std::string& name);
+
+  virtual int getNrVariables() const
+  {
+    return _highs.getNumCol();
+  }
+
+  virtual void setUpperBound(int var, double ub);
+
+  virtual void addRow(const Row& row);
+
+  virtual void addLazyRows(const RowVector& rows);
+
+  virtual int getNrRows() const
+  {
+    return _highs.getNumRow();
+  }
+
+  virtual void setIncumbentCallback(const IncumbentCallback& callback)
+  {
+    _incumbentCallback = callback;
+  }
+
+  virtual void setSeparationCallback(const SeparationCallback& callback)
+  {
+    _separationCallback = callback;
+  }
+
+  virtual void setObjective(const StlDoubleVector& coefs,
+                            double constant,
+                            bool maximize);
+
+  virtual void addMIPStart(const StlIntVector& vars,
+                           const StlDoubleVector& vals);
+
+  virtual void setParameters(int timeLimit,
+                             int memoryLimit,
+                             int nrThreads,
+                             bool verbose);
+
+  virtual void setProfile(const SolverProfile& profile);
+
+  virtual void setDeterministicTimeLimit(double)
+  {
+    // HiGHS has no deterministic time limit
+  }
+  
+  virtual double getDeterministicTime() const
+  {
+    return 0;
+  }
+
+  virtual bool solve();
+
+  virtual bool hasSolution() const
+  {
+    return _feasible;
+  }
+
+  virtual void getValues(StlDoubleVector& vals) const;
+
+  virtual double getObjValue() const
+  {
+    return _highs.getInfo().objective_function_value;
+  }
+
+  virtual double getBestObjValue() const
+  {
+    return _highs.getInfo().mip_dual_bound;
+  }
+
+  virtual void abort()
+  {
+    _aborted = true;
+  }
+
+private:
+  /// Handle HiGHS callback
+  ///
+  /// @param callbackType Callback type
+  /// @param dataOut Data passed by HiGHS
+  /// @param dataIn Data passed to HiGHS
+  void callback(int callbackType,
+                const HighsCallbackDataOut* dataOut,
+                HighsCallbackDataIn* dataIn);
+
+private:
+  /// HiGHS solver
+  Highs _highs;
+  /// Indicates whether solve has been aborted
+  std::atomic<bool> _aborted;
+  /// Time limit of solve in seconds, unlimited if non-positive
+  int _timeLimit;
+  /// Indicates whether the last solve found a solution violating no separated row
+  bool _feasible;
+  /// Incumbent callback
+  IncumbentCallback _incumbentCallback;
+  /// Separation callback
+  SeparationCallback _separationCallback;
+  /// Mutex protecting _pendingRows
+  std::mutex _mutex;
+  /// Rows separated from rejected improving solutions, added on the next re-solve
+  RowVector _pendingRows;
+};
+
+#endif // HIGHSBACKEND_H
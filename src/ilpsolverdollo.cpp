@@ -15,10 +15,13 @@ IlpSolverDollo::IlpSolverDollo(const Matrix& D,
   , _k(k)
   , _m(D.getNrTaxa())
   , _n(D.getNrCharacters())
-  , _env()
-  , _model(_env)
-  , _cplex(_model)
-  , _E(_env)
+  , _backendName(MipBackend::getDefaultBackend())
+  , _backend()
+  , _aborted(false)
+  , _optimal(false)
+  , _incumbentHandler()
+  , _profile()
+  , _budget(NULL)
   , _solE(_D.getNrTaxa(), _n)
 {
 }
@@ -31,37 +34,68 @@ IlpSolverDollo::IlpSolverDollo(const Matrix& D,
   , _k(k)
   , _m(m)
   , _n(n)
-  , _env()
-  , _model(_env)
-  , _cplex(_model)
-  , _E(_env)
+  , _backendName(MipBackend::getDefaultBackend())
+  , _backend()
+  , _aborted(false)
+  , _optimal(false)
+  , _incumbentHandler()
+  , _profile()
+  , _budget(NULL)
   , _solE(_D.getNrTaxa(), _n)
 {
 }
 
 void IlpSolverDollo::init()
 {
+  initBackend();
   initVariables();
   initConstraints();
   initFixedEntries();
   initObjective();
 }
 
+void IlpSolverDollo::initBackend()
+{
+  _backend.reset(MipBackend::create(_backendName));
+  if (!_backend)
+  {
+    throw std::runtime_error("Error: MIP backend '" + _backendName + "' is not available");
+  }
+}
+
+void IlpSolverDollo::initHotStart(const Matrix& E)
+{
+  StlIntVector startVar;
+  StlDoubleVector startVal;
+  
+  for (int p = 0; p < _m; ++p)
+  {
+    for (int c = 0; c < _n; ++c)
+    {
+      for (int i = 0; i <= _k + 1; ++i)
+      {
+        startVar.push_back(getIndex(p, c, i));
+        startVal.push_back(i == E.getEntry(p, c) ? 1 : 0);
+      }
+    }
+  }
+  
+  _backend->addMIPStart(startVar, startVal);
+}
+
 void IlpSolverDollo::initVariables()
 {
   char buf[1024];
   
-  _E = IloBoolVar3Matrix(_env, _m);
   for (int p = 0; p < _m; p++)
   {
-    _E[p] = IloBoolVarMatrix(_env, _n);
     for (int c = 0; c < _n; ++c)
     {
-      _E[p][c] = IloBoolVarArray(_env, _k + 2);
       for (int i = 0; i < _k + 2; ++i)
       {
         snprintf(buf, 1024, "e_%d_%d_%d", p, c, i);
-        _E[p][c][i] = IloBoolVar(_env, buf);
+        int var = _backend->addBinaryVariable(buf);
+        assert(var == getIndex(p, c, i));
       }
     }
   }
@@ -69,19 +103,18 @@ void IlpSolverDollo::initVariables()
 
 void IlpSolverDollo::initFixedEntries()
 {
-  IloExpr sum(_env);
   for (int p = 0; p < _m; p++)
   {
     for (int c = 0; c < _n; c++)
     {
       int d_pc = _D.getEntry(p, c);
-      if (d_pc == 1)
-      {
-        _model.add(_E[p][c][1] == 1);
-      }
-      else if (d_pc == 0)
+      if (d_pc == 0 || d_pc == 1)
       {
-        _model.add(_E[p][c][1] == 0);
+        MipBackend::Row row;
+        row._vars.push_back(getIndex(p, c, 1));
+        row._coefs.push_back(1);
+        row._lb = row._ub = d_pc;
+        _backend->addRow(row);
       }
     }
   }
@@ -89,112 +122,64 @@ void IlpSolverDollo::initFixedEntries()
 
 void IlpSolverDollo::initConstraints()
 {
-  IloExpr sum(_env);
-  
   // Each entry has a unique state
   for (int p = 0; p < _m; p++)
   {
     for (int c = 0; c < _n; c++)
     {
+      MipBackend::Row sum;
       for (int i = 0; i <= _k + 1; ++i)
       {
-        sum += _E[p][c][i];
+        sum._vars.push_back(getIndex(p, c, i));
+        sum._coefs.push_back(1);
       }
-      _model.add(sum == 1);
-      sum.clear();
+      sum._lb = sum._ub = 1;
+      _backend->addRow(sum);
     }
   }
   
   // disable superfluous states and symmetry breaking
-  IloExpr prevSum(_env);
   for (int c = 0; c < _n; c++)
   {
-    for (int i = 2; i <= _k + 1; ++i)
+    for (int i = 3; i <= _k + 1; ++i)
     {
+      MipBackend::Row diff;
       for (int p = 0; p < _m; p++)
       {
-        sum += _E[p][c][i];
+        diff._vars.push_back(getIndex(p, c, i - 1));
+        diff._coefs.push_back(1);
       }
-      if (i > 2)
+      for (int p = 0; p < _m; p++)
       {
-        _model.add(prevSum >= sum);
+        diff._vars.push_back(getIndex(p, c, i));
+        diff._coefs.push_back(-1);
       }
-      
-      std::swap(prevSum, sum);
-      sum.clear();
+      diff._lb = 0;
+      diff._ub = MipBackend::INF;
+      _backend->addRow(diff);
     }
   }
   
-  // Generalized three gamete condition
-//  for (int p = 0; p < m; ++p)
-//  {
-//    for (int q = 0; q < m; ++q)
-//    {
-//      if (q == p) continue;
-//      for (int r = 0; r < m; ++r)
-//      {
-//        if (r == p || r == q) continue;
-//        for (int c = 0; c < _n; ++c)
-//        {
-//          for (int d = c + 1; d < _n; ++d)
-//          {
-//            // condition 1
-//            for (int i = 1; i <= _k + 1; ++i)
-//            {
-//              for (int j = 2; j <= _k + 1; ++j)
-//              {
-//                _model.add(_E[p][c][i] + _E[q][c][0] + _E[r][c][i]
-//                           + (1 - _E[p][d][j]) + _E[q][d][j] + _E[r][d][j] <= 5);
-//              }
-//            }
-//
-//            // condition 2
-//            for (int i = 2; i <= _k + 1; ++i)
-//            {
-//              for (int j = 1; j <= _k + 1; ++j)
-//              {
-//                _model.add(_E[p][c][i] + (1 - _E[q][c][i]) + _E[r][c][i]
-//                           + _E[p][d][0] + _E[q][d][j] + _E[r][d][j] <= 5);
-//              }
-//            }
-//
-//            // condition 3
-//            for (int i = 2; i <= _k + 1; ++i)
-//            {
-//              for (int j = 2; j <= _k + 1; ++j)
-//              {
-//                _model.add(_E[p][c][i] + (1 - _E[q][c][i]) + _E[r][c][i]
-//                           + (1 - _E[p][d][j]) + _E[q][d][j] + _E[r][d][j] <= 5);
-//              }
-//            }
-//
-//            // condition 4
-//            _model.add(_E[p][c][1] + _E[q][c][0] + _E[r][c][1]
-//                       + _E[p][d][0] + _E[q][d][1] + _E[r][d][1] <= 5);
-//          }
-//        }
-//      }
-//    }
-//  }
+  // the forbidden submatrices are separated by DolloCallback
 }
 
 void IlpSolverDollo::initObjective()
 {
   double factor = 1. / (_m * _n);
   
-  IloExpr obj(_env);
+  StlDoubleVector obj(_backend->getNrVariables(), 0);
   for (int p = 0; p < _m; ++p)
   {
     for (int c = 0; c < _n; ++c)
     {
       for (int i = 2; i <= _k + 1; ++i)
       {
-        obj += pow(factor, _k + 1 - i) * _E[p][c][i];
+        obj[getIndex(p, c, i)] = 1000 * pow(factor, _k + 1 - i);
       }
     }
   }
   
-  _model.add(IloMinimize(_env, 1000 * obj));
+  _backend->setObjective(obj, 0, false);
 }
 
 bool IlpSolverDollo::solve(int timeLimit,
@@ -202,66 +187,93 @@ bool IlpSolverDollo::solve(int timeLimit,
                            int nrThreads,
                            bool verbose)
 {
-  if (!verbose)
+  _optimal = false;
+  if (_aborted)
   {
-    _env.setOut(_env.getNullStream());
-    _env.setError(_env.getNullStream());
-    _env.setWarning(_env.getNullStream());
-    _cplex.setOut(_env.getNullStream());
-    _cplex.setError(_env.getNullStream());
-    _cplex.setWarning(_env.getNullStream());
+    return false;
   }
-  else
+  
+  if (_budget)
   {
-    _env.setOut(std::cerr);
-    _env.setError(std::cerr);
-    _env.setWarning(std::cerr);
-    _cplex.setOut(std::cerr);
-    _cplex.setError(std::cerr);
-    _cplex.setWarning(std::cerr);
+    if (_budget->exceeded())
+    {
+      std::cerr << Budget::toString(_budget->check()) << std::endl;
+      return false;
+    }
+    double remaining = _budget->getRemainingTime(nrThreads);
+    if (remaining >= 0)
+    {
+      timeLimit = timeLimit > 0 ? std::min<int>(timeLimit, ceil(remaining)) : ceil(remaining);
+    }
+    _backend->setDeterministicTimeLimit(_budget->getRemainingSolverTicks());
   }
-
-  IloFastMutex mutex;
-  _cplex.use(IloCplex::Callback(new (_env) DolloCallback<IloCplex::UserCutCallbackI>(_env, _E, _m, _n, _k, &mutex)));
-  _cplex.use(IloCplex::Callback(new (_env) DolloCallback<IloCplex::LazyConstraintCallbackI>(_env, _E, _m, _n, _k, &mutex)));
-//  _cplex.use(IloCplex::Callback(new (_env) DolloHeuristic(_env, _E, m, _n, _k, &mutex)));
+  _backend->setParameters(timeLimit, memoryLimit, nrThreads, verbose);
   
-  _cplex.setParam(IloCplex::MIPEmphasis, IloCplex::MIPEmphasisFeasibility);
-  _cplex.setParam(IloCplex::ParallelMode, -1);
-  if (nrThreads > 0)
+  // search for feasible solutions first unless the profile says otherwise
+  SolverProfile profile = _profile;
+  if (!profile.hasParam("emphasis"))
   {
-    _cplex.setParam(IloCplex::Threads, nrThreads);
+    profile.setParam("emphasis", 1);
   }
-  if (timeLimit > 0)
+  _backend->setProfile(profile);
+  
+  _backend->setSeparationCallback(DolloCallback(_m, _n, _k));
+  if (_incumbentHandler)
   {
-    _cplex.setParam(IloCplex::TiLim, timeLimit);
+    _backend->setIncumbentCallback([this](const StlDoubleVector& vals)
+    {
+      _incumbentHandler(toMatrix(vals));
+    });
   }
-  if (memoryLimit > 0)
+  
+  double startTime = g_timer.realTime();
+  _optimal = _backend->solve();
+  std::cerr << "CPLEX time: " << g_timer.realTime() - startTime << std::endl;
+  if (_budget)
   {
-    _cplex.setParam(IloCplex::WorkMem, memoryLimit);
+    _budget->tickSolver(_backend->getDeterministicTime());
   }
-  
-//  _cplex.exportModel("/tmp/test.lp");
-  bool res = _cplex.solve();
+  bool res = _backend->hasSolution();
   if (res)
   {
-    std::cerr << "CPLEX: [" << _cplex.getObjValue() << " , " << _cplex.getBestObjValue() << "]" << std::endl;
+    std::cerr << "CPLEX: [" << _backend->getObjValue() << " , " << _backend->getBestObjValue() << "]" << std::endl;
     std::cerr << "Elapsed time: " << g_timer.realTime() << std::endl;
     processSolution();
   }
   return res;
 }
 
+Matrix IlpSolverDollo::toMatrix(const StlDoubleVector& vals) const
+{
+  Matrix E(_m, _n);
+  for (int p = 0; p < _m; ++p)
+  {
+    for (int c = 0; c < _n; ++c)
+    {
+      for (int i = 0; i <= _k + 1; ++i)
+      {
+        if (vals[getIndex(p, c, i)] > 0.5)
+        {
+          E.setEntry(p, c, i);
+        }
+      }
+    }
+  }
+  return E;
+}
+
 void IlpSolverDollo::processSolution()
 {
-  const int m = _D.getNrTaxa();
-  for (int p = 0; p < m; p++)
+  StlDoubleVector vals;
+  _backend->getValues(vals);
+  
+  for (int p = 0; p < _m; p++)
   {
     for (int c = 0; c < _n; ++c)
     {
       for (int i = 0; i <= _k + 1; ++i)
       {
-        bool e_pci = g_tol.nonZero(_cplex.getValue(_E[p][c][i]));
+        bool e_pci = g_tol.nonZero(vals[getIndex(p, c, i)]);
         if (e_pci)
         {
           _solE.setEntry(p, c, i);
@@ -283,15 +295,7 @@ void IlpSolverDollo::printSolution(std::ostream& out) const
       else
         out << " ";
       
-      for (int i = 0; i <= _k + 1; ++i)
-      {
-        bool e_pci = g_tol.nonZero(_cplex.getValue(_E[p][c][i]));
-        if (e_pci)
-        {
-          out << i;
-          break;
-        }
-      }
+      out << _solE.getEntry(p, c);
     }
     out << std::endl;
   }
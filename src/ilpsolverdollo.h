@@ -8,8 +8,13 @@
 #ifndef ILPSOLVERDOLLO_H
 #define ILPSOLVERDOLLO_H
 
-#include <ilcplex/ilocplex.h>
+#include <functional>
+#include <memory>
+#include <atomic>
 #include "matrix.h"
+#include "mipbackend.h"
+#include "solverprofile.h"
+#include "budget.h"
 
 /// Dollo phylogeny without errors
 class IlpSolverDollo
@@ -25,9 +30,14 @@ public:
   /// Destructor
   virtual ~IlpSolverDollo()
   {
-    _cplex.end();
-    _model.end();
-    _env.end();
+  }
+  
+  /// Set MIP backend, must be called before init()
+  ///
+  /// @param backend Backend name
+  void setBackend(const std::string& backend)
+  {
+    _backendName = backend;
   }
   
   /// Solve
@@ -39,6 +49,11 @@ public:
   /// Initialize solver
   virtual void init();
   
+  /// Provide MIP start
+  ///
+  /// @param E k-Dollo completion
+  void initHotStart(const Matrix& E);
+  
   /// Write solution
   ///
   /// @param out Output stream
@@ -50,6 +65,49 @@ public:
     return _solE;
   }
   
+  /// Return whether the last solve proved optimality
+  bool isOptimal() const
+  {
+    return _optimal;
+  }
+  
+  /// Abort solve, may be called from another thread
+  void abort()
+  {
+    _aborted = true;
+    if (_backend)
+    {
+      _backend->abort();
+    }
+  }
+  
+  /// Set solver profile
+  ///
+  /// @param profile Solver profile
+  void setProfile(const SolverProfile& profile)
+  {
+    _profile = profile;
+  }
+  
+  /// Set resource budget, checked in addition to the time limit of solve()
+  ///
+  /// @param budget Budget, may be NULL
+  void setBudget(Budget* budget)
+  {
+    _budget = budget;
+  }
+  
+  /// Handler receiving incumbents, called from solver threads
+  typedef std::function<void(const Matrix&)> IncumbentHandler;
+  
+  /// Set handler that receives every new incumbent during solve
+  ///
+  /// @param handler Incumbent handler
+  void setIncumbentHandler(const IncumbentHandler& handler)
+  {
+    _incumbentHandler = handler;
+  }
+  
 protected:
   /// Constructor
   ///
@@ -62,6 +120,9 @@ protected:
                  int m,
                  int n);
   
+  /// Create MIP backend
+  void initBackend();
+  
   /// Initialize variables
   virtual void initVariables();
   
@@ -74,13 +135,23 @@ protected:
   /// Initialize objective function (number of losses)
   virtual void initObjective();
   
-  /// Extract cplex solution
+  /// Extract solution
   virtual void processSolution();
   
-  typedef IloArray<IloBoolVarArray> IloBoolVarMatrix;
-  typedef IloArray<IloNumVarArray> IloNumVarMatrix;
-  typedef std::map<IntPair, IloNumVar> IloNumVarMatrixMap;
-  typedef IloArray<IloBoolVarMatrix> IloBoolVar3Matrix;
+  /// Convert variable values to a k-Dollo completion
+  ///
+  /// @param vals Variable values
+  Matrix toMatrix(const StlDoubleVector& vals) const;
+  
+  /// Return index of the variable indicating whether entry (p,c) has state i
+  ///
+  /// @param p Taxon
+  /// @param c Character
+  /// @param i State
+  int getIndex(int p, int c, int i) const
+  {
+    return (_n * (_k + 2)) * p + (_k + 2) * c + i;
+  }
 
 protected:
   /// Input matrix
@@ -91,14 +162,20 @@ protected:
   const int _m;
   /// Number of characters
   const int _n;
-  /// Cplex environment
-  IloEnv _env;
-  /// Cplex model
-  IloModel _model;
-  /// Cplex solver
-  IloCplex _cplex;
-  /// _E[p][c][i] is the multi-state matrix
-  IloBoolVar3Matrix _E;
+  /// MIP backend name
+  std::string _backendName;
+  /// MIP backend, variable getIndex(p,c,i) indicates whether entry (p,c) has state i
+  std::unique_ptr<MipBackend> _backend;
+  /// Indicates whether abort() has been called
+  std::atomic<bool> _aborted;
+  /// Indicates whether the last solve proved optimality
+  bool _optimal;
+  /// Incumbent handler
+  IncumbentHandler _incumbentHandler;
+  /// Solver profile
+  SolverProfile _profile;
+  /// Resource budget, may be NULL
+  Budget* _budget;
   /// Solution matrix
   Matrix _solE;
 };
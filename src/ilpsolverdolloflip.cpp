@@ -31,6 +31,7 @@ IlpSolverDolloFlip::IlpSolverDolloFlip(const Matrix& D,
 
 void IlpSolverDolloFlip::init()
 {
+  initBackend();
   initVariables();
   initConstraints();
   initObjective();
@@ -45,15 +46,8 @@ void IlpSolverDolloFlip::initObjective()
   const double log_1_minus_alpha = log(1 - _alpha);
   const double log_beta = log(_beta);
   const double log_1_minus_beta = log(1 - _beta);
-//  const double logg_beta = log_beta - log_1_minus_beta;
-//  const double logg_alpha = log_alpha - log_1_minus_alpha;
-  
-  IloExpr obj(_env);
-  IloExpr x(_env);   // 0 (input) to 1 (output) FN
-  IloExpr y(_env);   // 1 (input) to 0,2,3... (output) FP
-  int X = 0;         // zeros in D
-  int Y = 0;         // ones in D
   
+  StlDoubleVector obj(_backend->getNrVariables(), 0);
   for (int p = 0; p < m; p++)
   {
     for (int c = 0; c < n; c++)
@@ -61,49 +55,22 @@ void IlpSolverDolloFlip::initObjective()
       int d_pc = _D.getEntry(p, c);
       if (d_pc == 0)
       {
-        ++X;
         for (int j = 0; j <= _k + 1; ++j)
         {
-          if (j == 0)
-          {
-            obj += log_1_minus_alpha * _E[p][c][j];
-          }
-          else if (j == 1)
-          {
-            obj += log_beta * _E[p][c][j];
-            x += _E[p][c][j];
-          }
-          else
-          {
-            obj += log_1_minus_alpha * _E[p][c][j];
-          }
+          // 0 (input) to 1 (output) is a false negative
+          obj[getIndex(p, c, j)] = j == 1 ? log_beta : log_1_minus_alpha;
         }
       }
       else if (d_pc == 1)
       {
-        ++Y;
         for (int j = 0; j <= _k + 1; ++j)
         {
-          if (j == 0)
-          {
-            obj += log_alpha * _E[p][c][j];
-            y += _E[p][c][j];
-          }
-          else if (j == 1)
-          {
-            obj += log_1_minus_beta * _E[p][c][j];
-          }
-          else
-          {
-            obj += log_alpha * _E[p][c][j];
-            y += _E[p][c][j];
-          }
+          // 1 (input) to 0,2,3... (output) is a false positive
+          obj[getIndex(p, c, j)] = j == 1 ? log_1_minus_beta : log_alpha;
         }
       }
     }
   }
-//  obj.clear();
-//  obj += logg_beta * x + logg_alpha * y + X * log_1_minus_beta + Y * log_1_minus_alpha;
   
   double unit = std::max(log_alpha, std::max(log_beta, std::max(log_1_minus_alpha, log_1_minus_beta)));
   for (int p = 0; p < m; ++p)
@@ -112,11 +79,14 @@ void IlpSolverDolloFlip::initObjective()
     {
       for (int i = 2; i <= _k + 1; ++i)
       {
-        obj += _E[p][c][i] * (unit / (m * n));
+        obj[getIndex(p, c, i)] += unit / (m * n);
       }
     }
   }
   
-  _model.add(IloMaximize(_env, 1000 * obj));
-//  _model.add(IloMinimize(_env, obj));
+  for (double& coef : obj)
+  {
+    coef *= 1000;
+  }
+  _backend->setObjective(obj, 0, true);
 }
@@ -10,6 +10,7 @@
 #include "matrix.h"
 //#include "ilpsolverdolloflipcluster.h"
 #include "coordinateascent.h"
+#include "mipbackend.h"
 
 int main(int argc, char** argv)
 {
@@ -21,11 +22,23 @@ int main(int argc, char** argv)
   int s = 10;
   int seed = 0;
   int memoryLimit = -1;
+  int rssLimit = -1;
   int nrThreads = 1;
   int timeLimit = -1;
+  double cpuTimeLimit = -1;
+  double tickLimit = -1;
+  double solverTickLimit = -1;
   bool verbose = false;
   bool lazy = true;
   int restarts = 10;
+  int levels = 1;
+  bool automatic = false;
+  int patience = 2;
+  int raceIterations = 0;
+  double raceMargin = 0.01;
+  bool noGreedy = false;
+  std::string backend = MipBackend::getDefaultBackend();
+  std::string profileName = "balanced";
   
   lemon::ArgParser ap(argc, argv);
   ap.refOption("k", "Maximum number of losses per SNV (default: 1)", k)
@@ -34,15 +47,62 @@ int main(int argc, char** argv)
     .refOption("lC", "Number of character clusters (default: 15)", t)
     .refOption("lT", "Number of taxon clusters (default: 10)", s)
     .refOption("N", "Number of restarts (default: 10)", restarts)
+    .refOption("levels", "Number of levels: solve for lT / 2^(levels-1) and lC / 2^(levels-1) clusters (rounded up), then split the worst-fitting clusters and re-solve until lT and lC are reached; restarts are only performed at the coarsest level (default: 1)", levels)
+    .refOption("race", "Race restarts in rounds of the given number of iterations, stopping restarts that trail the best one (default: 0, disabled)", raceIterations)
+    .refOption("margin", "Relative log likelihood margin of -race (default: 0.01)", raceMargin)
+    .refOption("auto", "Select the number of clusters by BIC, lT and lC are the maximum numbers of clusters", automatic)
+    .refOption("patience", "Number of steps without BIC improvement before -auto stops (default: 2)", patience)
     .refOption("s", "Random number generator seed (default: 0)", seed)
     .refOption("T", "Time limit in seconds (default: -1, unlimited).", timeLimit)
     .refOption("t", "Number of threads (default: 1)", nrThreads)
     .refOption("M", "Memory limit in MB (default: -1, unlimited)", memoryLimit)
+    .refOption("rss", "Peak resident set size limit in MB, stops the run when exceeded (default: -1, unlimited)", rssLimit)
+    .refOption("cpu", "CPU time limit in seconds (default: -1, unlimited)", cpuTimeLimit)
+    .refOption("ticks", "Deterministic tick limit on SPhyR's own work (default: -1, unlimited)", tickLimit)
+    .refOption("solver-ticks", "Deterministic time limit of all MIP solves in solver ticks (default: -1, unlimited)", solverTickLimit)
     .refOption("v", "Verbose output", verbose)
+    .refOption("G", "Disable greedy MIP start", noGreedy)
+    .refOption("backend", "MIP backend (default: " + backend + ")", backend)
+    .refOption("profile", "Solver profile: fast, balanced, proof or profile file (default: balanced)", profileName)
     .other("input", "Input file")
     .other("output", "Output file");
   ap.parse();
 
+  if (!MipBackend::isAvailable(backend))
+  {
+    std::cerr << "Error: MIP backend '" << backend << "' is not available" << std::endl;
+    return 1;
+  }
+
+  SolverProfile profile;
+  if (!profile.load(profileName))
+  {
+    return 1;
+  }
+  
+  if (levels < 1 || levels > 31)
+  {
+    std::cerr << "Error: number of levels should be between 1 and 31" << std::endl;
+    return 1;
+  }
+  if (patience < 1)
+  {
+    std::cerr << "Error: patience should be positive" << std::endl;
+    return 1;
+  }
+  if (raceIterations < 0 || raceMargin < 0)
+  {
+    std::cerr << "Error: -race and -margin should be non-negative" << std::endl;
+    return 1;
+  }
+  if (automatic && levels > 1)
+  {
+    std::cerr << "Error: -auto and -levels are mutually exclusive" << std::endl;
+    return 1;
+  }
+  
+  Budget budget(timeLimit, cpuTimeLimit, tickLimit, solverTickLimit, rssLimit);
+
   Matrix D;
   if (!ap.files().empty())
   {
@@ -65,13 +125,29 @@ int main(int argc, char** argv)
   std::string outputFilename = ap.files().size() > 1 ? ap.files()[1] : "";
     
   StlIntVector characterMapping, taxonMapping;
-  Matrix simpleD = D.simplify(characterMapping, taxonMapping);
+  Matrix simpleD = D.simplify(characterMapping, taxonMapping, &budget);
   
   CoordinateAscent ca(simpleD,
                       characterMapping,
                       taxonMapping,
                       k, lazy, alpha, beta, s, t, seed);
-  ca.solve(timeLimit, memoryLimit, nrThreads, verbose, restarts);
+  ca.setGreedy(!noGreedy);
+  ca.setRacing(raceIterations, raceMargin);
+  ca.setBackend(backend);
+  ca.setProfile(profile);
+  ca.setBudget(&budget);
+  if (automatic)
+  {
+    ca.solveAutomatic(timeLimit, memoryLimit, nrThreads, verbose, restarts, patience);
+  }
+  else if (levels > 1)
+  {
+    ca.solveMultilevel(timeLimit, memoryLimit, nrThreads, verbose, restarts, levels);
+  }
+  else
+  {
+    ca.solve(timeLimit, memoryLimit, nrThreads, verbose, restarts);
+  }
   Matrix bestA = ca.getE();
   bestA = bestA.expandColumns(ca.getZC());
   bestA = bestA.expandRows(ca.getZT());
@@ -0,0 +1,107 @@
+/*
+ * kdpflsmain.cpp
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#include <fstream>
+#include <lemon/arg_parser.h>
+#include "matrix.h"
+#include "localsearch.h"
+#include "dollophylogenetictree.h"
+
+int main(int argc, char** argv)
+{
+  int k = 1;
+  double alpha = 1e-3;
+  double beta = 0.3;
+  int nrIterations = 100000;
+  int nrChains = -1;
+  int nrThreads = 1;
+  int timeLimit = -1;
+  int seed = 0;
+  double temperature = 1;
+  std::string dotFilename;
+
+  lemon::ArgParser ap(argc, argv);
+  ap.refOption("k", "Maximum number of losses per SNV (default: 1)", k)
+    .refOption("a", "False positive rate (default: 1e-3)", alpha)
+    .refOption("b", "False negative rate (default: 0.3)", beta)
+    .refOption("N", "Number of moves per chain (default: 100000)", nrIterations)
+    .refOption("C", "Number of independent chains (default: -1, number of threads)", nrChains)
+    .refOption("t", "Number of threads (default: 1)", nrThreads)
+    .refOption("T", "Time limit in seconds (default: -1, unlimited)", timeLimit)
+    .refOption("s", "Random number generator seed (default: 0)", seed)
+    .refOption("temp", "Initial annealing temperature (default: 1)", temperature)
+    .refOption("dot", "Write k-Dollo phylogeny in DOT format to the given file", dotFilename)
+    .other("input", "Input file")
+    .other("output", "Output file");
+  ap.parse();
+
+  if (!(0 < alpha && alpha < 1) || !(0 < beta && beta < 1))
+  {
+    std::cerr << "Error: error rates must be in (0,1)" << std::endl;
+    return 1;
+  }
+
+  Matrix D;
+  if (!ap.files().empty())
+  {
+    std::ifstream inD(ap.files()[0]);
+    if (!inD.good())
+    {
+      std::cerr << "Error: failed to open '" << ap.files()[0] << "' for reading"
+                << std::endl;
+      return 1;
+    }
+
+    inD >> D;
+    inD.close();
+  }
+  else
+  {
+    std::cin >> D;
+  }
+
+  std::string outputFilename = ap.files().size() > 1 ? ap.files()[1] : "";
+
+  if (nrChains <= 0)
+  {
+    nrChains = std::max(nrThreads, 1);
+  }
+
+  LocalSearch solver(D, k, alpha, beta);
+  solver.solve(nrIterations, nrChains, nrThreads, temperature, timeLimit, seed);
+  const Matrix& A = solver.getSolA();
+
+  std::cerr << "Solution likelihood: " << solver.getLogLikelihood() << std::endl;
+  std::cerr << "Elapsed time: " << g_timer.realTime() << std::endl;
+
+  if (!dotFilename.empty())
+  {
+    DolloPhylogeneticTree T(A);
+    if (T.reconstructTree(nrThreads))
+    {
+      std::ofstream outDOT(dotFilename.c_str());
+      T.writeDOT(outDOT);
+    }
+    else
+    {
+      std::cerr << "Error: failed to reconstruct k-Dollo phylogeny" << std::endl;
+    }
+  }
+
+  if (outputFilename.empty())
+  {
+    std::cout << A;
+  }
+  else
+  {
+    std::ofstream outFile(outputFilename.c_str());
+    outFile << A;
+    outFile.close();
+  }
+
+  return 0;
+}
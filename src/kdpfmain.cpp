@@ -8,37 +8,135 @@
 #include <fstream>
 #include <lemon/arg_parser.h>
 #include "matrix.h"
-#include "ilpsolverdolloflip.h"
 #include "phylogenetictree.h"
 #include "columngenflip.h"
+#include "greedydollo.h"
+#include "ksweep.h"
+#include "errorratesweep.h"
+#include "ilpsolverdolloflip.h"
+#include "portfoliosolver.h"
 
 int main(int argc, char** argv)
 {
   std::string filename;
   int k = 1;
   int memoryLimit = -1;
+  int rssLimit = -1;
   int nrThreads = 1;
   int timeLimit = -1;
+  double cpuTimeLimit = -1;
+  double tickLimit = -1;
+  double solverTickLimit = -1;
   double alpha = 1e-3;
   double beta = 0.3;
   bool verbose = false;
   bool columnGeneration = false;
+  bool portfolio = false;
   bool lazy = true;
+  bool noGreedy = false;
+  std::string backend = MipBackend::getDefaultBackend();
+  std::string profileName = "balanced";
+  std::string ilpProfileName = "fast";
+  std::string kRange;
+  bool kRangeVerify = false;
+  std::string alphaGrid;
+  std::string betaGrid;
   
   lemon::ArgParser ap(argc, argv);
   ap.refOption("c", "Enable column generation", columnGeneration)
+    .refOption("P", "Run ILP and column generation concurrently, threads are split between both", portfolio)
     .refOption("k", "Maximum number of losses per SNV (default: 1)", k)
     .refOption("T", "Time limit in seconds (default: -1, unlimited)", timeLimit)
     .refOption("t", "Number of threads (default: 1)", nrThreads)
     .refOption("M", "Memory limit in MB (default: -1, unlimited)", memoryLimit)
+    .refOption("rss", "Peak resident set size limit in MB, stops the run when exceeded (default: -1, unlimited)", rssLimit)
+    .refOption("cpu", "CPU time limit in seconds (default: -1, unlimited)", cpuTimeLimit)
+    .refOption("ticks", "Deterministic tick limit on SPhyR's own work (default: -1, unlimited)", tickLimit)
+    .refOption("solver-ticks", "Deterministic time limit of all MIP solves in solver ticks (default: -1, unlimited)", solverTickLimit)
     .refOption("v", "Verbose output", verbose)
+    .refOption("G", "Disable greedy MIP start", noGreedy)
+    .refOption("backend", "MIP backend (default: " + backend + ")", backend)
+    .refOption("profile", "Solver profile: fast, balanced, proof or profile file (default: balanced)", profileName)
+    .refOption("ilp-profile", "Solver profile of the ILP when running with -P (default: fast)", ilpProfileName)
+    .refOption("k-range", "Solve k = a, a+1, ..., b with column generation warm starting each k from the previous one, given as 'a:b' (overrides -k); solutions are written to '<output>.k<k>'", kRange)
+    .refOption("k-range-verify", "Verify every warm started k of -k-range against a cold solve", kRangeVerify)
     .refOption("a", "False positive rate (default: 1e-3)", alpha)
     .refOption("b", "False negative rate (default: 0.3)", beta)
+    .refOption("a-grid", "Comma-separated false positive rates of an error rate sweep, which reuses one column generation model and writes a likelihood table instead of a completion", alphaGrid)
+    .refOption("b-grid", "Comma-separated false negative rates of an error rate sweep", betaGrid)
 //    .refOption("lazy", "Use lazy constraints", lazy)
     .other("input", "Input file")
     .other("output", "Output file");
   ap.parse();
   
+  if (!MipBackend::isAvailable(backend))
+  {
+    std::cerr << "Error: MIP backend '" << backend << "' is not available" << std::endl;
+    return 1;
+  }
+  
+  SolverProfile profile;
+  if (!profile.load(profileName))
+  {
+    return 1;
+  }
+  
+  SolverProfile ilpProfile;
+  if (portfolio && !ilpProfile.load(ilpProfileName))
+  {
+    return 1;
+  }
+  
+  Budget budget(timeLimit, cpuTimeLimit, tickLimit, solverTickLimit, rssLimit);
+  
+  if (!kRange.empty())
+  {
+    if (portfolio)
+    {
+      std::cerr << "Error: -k-range and -P are mutually exclusive" << std::endl;
+      return 1;
+    }
+    // constraints are carried over between column generation solvers
+    columnGeneration = true;
+  }
+  
+  StlDoubleVector alphas, betas;
+  const bool errorRateSweep = !alphaGrid.empty() || !betaGrid.empty();
+  if (errorRateSweep)
+  {
+    bool valid = true;
+    if (alphaGrid.empty())
+    {
+      alphas.push_back(alpha);
+      valid &= 0 < alpha && alpha < 1;
+    }
+    else
+    {
+      valid &= ErrorRateSweep::parseRates(alphaGrid, alphas);
+    }
+    if (betaGrid.empty())
+    {
+      betas.push_back(beta);
+      valid &= 0 < beta && beta < 1;
+    }
+    else
+    {
+      valid &= ErrorRateSweep::parseRates(betaGrid, betas);
+    }
+    if (!valid)
+    {
+      std::cerr << "Error: invalid error rate grid" << std::endl;
+      return 1;
+    }
+    if (portfolio || !kRange.empty())
+    {
+      std::cerr << "Error: -a-grid and -b-grid cannot be combined with -P or -k-range" << std::endl;
+      return 1;
+    }
+    // only the column generation model is updated in place
+    columnGeneration = true;
+  }
+  
   if (ap.files().empty())
   {
     std::cerr << "Error: missing input file" << std::endl;
@@ -59,13 +157,104 @@ int main(int argc, char** argv)
   inD >> D;
   inD.close();
   
+  const Matrix orgD = D;
   StlIntVector characterMapping, taxonMapping;
-  D = D.simplify(characterMapping, taxonMapping);
+  D = D.simplify(characterMapping, taxonMapping, &budget);
   
-  if (columnGeneration)
+  if (!kRange.empty())
   {
-    ColumnGenFlip solver(D, k, lazy, alpha, beta);
+    int minK = -1, maxK = -1;
+    if (!KSweep::parseRange(kRange, minK, maxK))
+    {
+      std::cerr << "Error: invalid k range '" << kRange << "'" << std::endl;
+      return 1;
+    }
+    
+    KSweep sweep(minK, maxK, [&](int k)
+    {
+      ColumnGenFlip* pSolver = new ColumnGenFlip(D, k, lazy, alpha, beta);
+      pSolver->setBackend(backend);
+      pSolver->setProfile(profile);
+      pSolver->setBudget(&budget);
+      pSolver->init();
+      if (!noGreedy)
+      {
+        GreedyDollo greedy(D, k);
+        greedy.solve();
+        pSolver->initHotStart(greedy.getSolA());
+      }
+      return pSolver;
+    });
+    
+    sweep.setVerify(kRangeVerify);
+    bool solved = sweep.solve(timeLimit, memoryLimit, nrThreads, verbose);
+    for (const KSweep::Result& result : sweep.getResults())
+    {
+      if (!result._solved)
+        continue;
+      
+      Matrix A = result._solA.expand(characterMapping, taxonMapping);
+      if (outputFilename.empty())
+      {
+        std::cout << A;
+      }
+      else
+      {
+        std::ofstream outE((outputFilename + ".k" + std::to_string(result._k)).c_str());
+        outE << A;
+        outE.close();
+      }
+    }
+    sweep.writeSummary(std::cerr);
+    
+    return solved ? 0 : 1;
+  }
+  
+  GreedyDollo greedy(D, k);
+  if (!noGreedy)
+  {
+    greedy.solve();
+  }
+  
+  if (errorRateSweep)
+  {
+    ColumnGenFlip solver(D, k, lazy, alphas.front(), betas.front());
+    solver.setBackend(backend);
+    solver.setProfile(profile);
+    solver.setBudget(&budget);
     solver.init();
+    if (!noGreedy)
+    {
+      solver.initHotStart(greedy.getSolA());
+    }
+    
+    ErrorRateSweep sweep(solver, orgD, characterMapping, taxonMapping, alphas, betas);
+    bool solved = sweep.solve(timeLimit, memoryLimit, nrThreads, verbose);
+    if (outputFilename.empty())
+    {
+      sweep.writeTable(std::cout);
+    }
+    else
+    {
+      std::ofstream outTable(outputFilename.c_str());
+      sweep.writeTable(outTable);
+      outTable.close();
+    }
+    
+    return solved ? 0 : 1;
+  }
+  
+  if (portfolio)
+  {
+    PortfolioSolver solver(D, k, lazy, alpha, beta);
+    solver.setBackend(backend);
+    solver.setProfiles(ilpProfile, profile);
+    solver.setBudget(&budget);
+    solver.init();
+    if (!noGreedy)
+    {
+      solver.initHotStart(greedy.getSolA());
+    }
     
     if (solver.solve(timeLimit, memoryLimit, nrThreads, verbose))
     {
@@ -82,10 +271,17 @@ int main(int argc, char** argv)
       }
     }
   }
-  else
+  else if (!columnGeneration)
   {
     IlpSolverDolloFlip solver(D, k, alpha, beta);
+    solver.setBackend(backend);
+    solver.setProfile(profile);
+    solver.setBudget(&budget);
     solver.init();
+    if (!noGreedy)
+    {
+      solver.initHotStart(greedy.getSolA());
+    }
     
     if (solver.solve(timeLimit, memoryLimit, nrThreads, verbose))
     {
@@ -102,6 +298,33 @@ int main(int argc, char** argv)
       }
     }
   }
+  else
+  {
+    ColumnGenFlip solver(D, k, lazy, alpha, beta);
+    solver.setBackend(backend);
+    solver.setProfile(profile);
+    solver.setBudget(&budget);
+    solver.init();
+    if (!noGreedy)
+    {
+      solver.initHotStart(greedy.getSolA());
+    }
+    
+    if (solver.solve(timeLimit, memoryLimit, nrThreads, verbose))
+    {
+      Matrix A = solver.getSolA().expand(characterMapping, taxonMapping);
+      if (outputFilename.empty())
+      {
+        std::cout << A;
+      }
+      else
+      {
+        std::ofstream outE(outputFilename.c_str());
+        outE << A;
+        outE.close();
+      }
+    }
+  }
   
   return 0;
 }
@@ -10,27 +10,61 @@
 #include "matrix.h"
 #include "phylogenetictree.h"
 #include "columngen.h"
+#include "greedydollo.h"
+#include "ksweep.h"
 
 int main(int argc, char** argv)
 {
   std::string filename;
   int k = 1;
   int memoryLimit = -1;
+  int rssLimit = -1;
   int nrThreads = 1;
   int timeLimit = -1;
+  double cpuTimeLimit = -1;
+  double tickLimit = -1;
+  double solverTickLimit = -1;
   bool verbose = false;
   bool lazy = true;
+  bool noGreedy = false;
+  std::string backend = MipBackend::getDefaultBackend();
+  std::string profileName = "balanced";
+  std::string kRange;
+  bool kRangeVerify = false;
   
   lemon::ArgParser ap(argc, argv);
   ap.refOption("k", "Maximum number of losses per character (default: 1)", k)
     .refOption("T", "Time limit in seconds (default: -1, unlimited)", timeLimit)
     .refOption("t", "Number of threads (default: 1)", nrThreads)
     .refOption("M", "Memory limit in MB (default: -1, unlimited)", memoryLimit)
+    .refOption("rss", "Peak resident set size limit in MB, stops the run when exceeded (default: -1, unlimited)", rssLimit)
+    .refOption("cpu", "CPU time limit in seconds (default: -1, unlimited)", cpuTimeLimit)
+    .refOption("ticks", "Deterministic tick limit on SPhyR's own work (default: -1, unlimited)", tickLimit)
+    .refOption("solver-ticks", "Deterministic time limit of all MIP solves in solver ticks (default: -1, unlimited)", solverTickLimit)
     .refOption("v", "Verbose output", verbose)
+    .refOption("G", "Disable greedy MIP start", noGreedy)
+    .refOption("backend", "MIP backend (default: " + backend + ")", backend)
+    .refOption("profile", "Solver profile: fast, balanced, proof or profile file (default: balanced)", profileName)
+    .refOption("k-range", "Solve k = a, a+1, ..., b warm starting each k from the previous one, given as 'a:b' (overrides -k); solutions are written to '<output>.k<k>'", kRange)
+    .refOption("k-range-verify", "Verify every warm started k of -k-range against a cold solve", kRangeVerify)
     .other("input", "Input file")
     .other("output", "Output file");
   ap.parse();
   
+  if (!MipBackend::isAvailable(backend))
+  {
+    std::cerr << "Error: MIP backend '" << backend << "' is not available" << std::endl;
+    return 1;
+  }
+  
+  SolverProfile profile;
+  if (!profile.load(profileName))
+  {
+    return 1;
+  }
+  
+  Budget budget(timeLimit, cpuTimeLimit, tickLimit, solverTickLimit, rssLimit);
+  
   Matrix D;
   if (!ap.files().empty())
   {
@@ -53,10 +87,63 @@ int main(int argc, char** argv)
   std::string outputFilename = ap.files().size() > 1 ? ap.files()[1] : "";
   
   StlIntVector chacterMapping, taxonMapping;
-  D = D.simplify(chacterMapping, taxonMapping);
+  D = D.simplify(chacterMapping, taxonMapping, &budget);
+  
+  auto createSolver = [&](int k)
+  {
+    ColumnGen* pSolver = new ColumnGen(D, k, lazy);
+    pSolver->setBackend(backend);
+    pSolver->setProfile(profile);
+    pSolver->setBudget(&budget);
+    pSolver->init();
+    if (!noGreedy)
+    {
+      // without flips the greedy completion is only feasible if it matches D
+      GreedyDollo greedy(D, k);
+      greedy.solve();
+      if (greedy.getNrFlips() == 0)
+      {
+        pSolver->initHotStart(greedy.getSolA());
+      }
+    }
+    return pSolver;
+  };
+  
+  if (!kRange.empty())
+  {
+    int minK = -1, maxK = -1;
+    if (!KSweep::parseRange(kRange, minK, maxK))
+    {
+      std::cerr << "Error: invalid k range '" << kRange << "'" << std::endl;
+      return 1;
+    }
+    
+    KSweep sweep(minK, maxK, createSolver);
+    sweep.setVerify(kRangeVerify);
+    bool solved = sweep.solve(timeLimit, memoryLimit, nrThreads, verbose);
+    for (const KSweep::Result& result : sweep.getResults())
+    {
+      if (!result._solved)
+        continue;
+      
+      if (outputFilename.empty())
+      {
+        std::cout << result._solA.expand(chacterMapping, taxonMapping);
+      }
+      else
+      {
+        std::ofstream outE((outputFilename + ".k" + std::to_string(result._k)).c_str());
+        outE << result._solA.expand(chacterMapping, taxonMapping);
+        outE.close();
+      }
+    }
+    sweep.writeSummary(std::cerr);
+    
+    return solved ? 0 : 1;
+  }
   
-  ColumnGen solver(D, k, lazy);
-  solver.init();
+  std::unique_ptr<ColumnGen> pSolver(createSolver(k));
+  ColumnGen& solver = *pSolver;
   if (solver.solve(timeLimit, memoryLimit, nrThreads, verbose))
   {
     if (outputFilename.empty())
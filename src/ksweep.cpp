@@ -0,0 +1,143 @@
+/*
+ * ksweep.cpp
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#include "ksweep.h"
+#include <cmath>
+
+KSweep::KSweep(int minK,
+               int maxK,
+               const SolverFactory& factory)
+  : _minK(minK)
+  , _maxK(maxK)
+  , _factory(factory)
+  , _verify(false)
+  , _results()
+{
+}
+
+bool KSweep::solve(int timeLimit,
+                   int memoryLimit,
+                   int nrThreads,
+                   bool verbose)
+{
+  _results.clear();
+  
+  std::unique_ptr<ColumnGen> pPrevSolver;
+  for (int k = _minK; k <= _maxK; ++k)
+  {
+    std::cerr << "Solving k = " << k << std::endl;
+    double startTime = g_timer.realTime();
+    
+    std::unique_ptr<ColumnGen> pSolver(_factory(k));
+    pSolver->setRecordConstraints(true);
+    if (pPrevSolver)
+    {
+      pSolver->importConstraints(*pPrevSolver);
+      pSolver->initHotStart(pPrevSolver->getSolA());
+    }
+    
+    Result result;
+    result._k = k;
+    result._solved = pSolver->solve(timeLimit, memoryLimit, nrThreads, verbose);
+    result._objValue = result._solved ? pSolver->getObjValue() : 0;
+    result._nrLosses = 0;
+    result._time = g_timer.realTime() - startTime;
+    result._coldObjValue = 0;
+    result._verified = false;
+    if (result._solved)
+    {
+      result._solA = pSolver->getSolA();
+      for (int i = 2; i <= k + 1; ++i)
+      {
+        result._nrLosses += result._solA.getCount(i);
+      }
+      
+      if (_verify && !pPrevSolver)
+      {
+        // the first solve is not warm started
+        result._coldObjValue = result._objValue;
+        result._verified = true;
+      }
+      else if (_verify)
+      {
+        std::cerr << "Verifying k = " << k << " with a cold solve" << std::endl;
+        std::unique_ptr<ColumnGen> pColdSolver(_factory(k));
+        if (!pColdSolver->solve(timeLimit, memoryLimit, nrThreads, verbose))
+        {
+          std::cerr << "Error: cold solve for k = " << k << " failed" << std::endl;
+        }
+        else
+        {
+          result._coldObjValue = pColdSolver->getObjValue();
+          double tol = 1e-4 * std::max(1., fabs(result._coldObjValue));
+          result._verified = fabs(result._objValue - result._coldObjValue) <= tol;
+          if (!result._verified)
+          {
+            std::cerr << "Error: warm started optimum " << result._objValue
+                      << " for k = " << k << " differs from cold optimum "
+                      << result._coldObjValue << std::endl;
+          }
+        }
+      }
+    }
+    _results.push_back(result);
+    
+    if (!result._solved || (_verify && !result._verified))
+    {
+      return false;
+    }
+    pPrevSolver = std::move(pSolver);
+  }
+  
+  return true;
+}
+
+void KSweep::writeSummary(std::ostream& out) const
+{
+  out << "k,solved,objective,losses,time";
+  if (_verify)
+  {
+    out << ",cold_objective,verified";
+  }
+  out << std::endl;
+  for (const Result& result : _results)
+  {
+    out << result._k << ","
+        << result._solved << ","
+        << result._objValue << ","
+        << result._nrLosses << ","
+        << result._time;
+    if (_verify)
+    {
+      out << "," << result._coldObjValue
+          << "," << result._verified;
+    }
+    out << std::endl;
+  }
+}
+
+bool KSweep::parseRange(const std::string& str, int& minK, int& maxK)
+{
+  size_t pos = str.find(':');
+  try
+  {
+    if (pos == std::string::npos)
+    {
+      minK = maxK = std::stoi(str);
+    }
+    else
+    {
+      minK = std::stoi(str.substr(0, pos));
+      maxK = std::stoi(str.substr(pos + 1));
+    }
+  }
+  catch (std::logic_error&)
+  {
+    return false;
+  }
+  return 0 <= minK && minK <= maxK;
+}
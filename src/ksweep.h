@@ -0,0 +1,117 @@
+/*
+ * ksweep.h
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#ifndef KSWEEP_H
+#define KSWEEP_H
+
+#include "utils.h"
+#include "matrix.h"
+#include "columngen.h"
+#include <functional>
+#include <memory>
+
+/// This class solves the same matrix for an increasing maximum number of
+/// losses per character in one process.
+///
+/// A k-Dollo completion is also a (k+1)-Dollo completion, so the solver for
+/// k + 1 losses is warm started with the optimum for k losses as MIP start
+/// and with the forbidden submatrices separated for k losses, which remain
+/// forbidden.
+class KSweep
+{
+public:
+  /// Function returning an initialized solver for the given number of losses
+  typedef std::function<ColumnGen*(int k)> SolverFactory;
+  
+  /// Result for a single number of losses
+  struct Result
+  {
+    /// Maximum number of losses per character
+    int _k;
+    /// Indicates whether the solver succeeded
+    bool _solved;
+    /// Objective value
+    double _objValue;
+    /// Number of entries in a lost state
+    int _nrLosses;
+    /// Wall time in seconds
+    double _time;
+    /// Objective value of the cold solve, if verified
+    double _coldObjValue;
+    /// Indicates whether the cold solve found the same optimum, if verified
+    bool _verified;
+    /// Solution
+    Matrix _solA;
+  };
+  
+  typedef std::vector<Result> ResultVector;
+  
+  /// Constructor
+  ///
+  /// @param minK Minimum number of losses per character
+  /// @param maxK Maximum number of losses per character
+  /// @param factory Solver factory
+  KSweep(int minK,
+         int maxK,
+         const SolverFactory& factory);
+  
+  /// Set whether every warm started solve is verified against a cold solve
+  /// of a fresh solver, which does not import constraints and is not warm
+  /// started with the previous optimum. The optima must agree up to the
+  /// default relative MIP gap of 1e-4.
+  ///
+  /// @param verify Verify warm started solves
+  void setVerify(bool verify)
+  {
+    _verify = verify;
+  }
+  
+  /// Solve for every number of losses, stops at the first failure. Returns
+  /// true if all numbers of losses were solved (and verified).
+  ///
+  /// @param timeLimit Time limit in seconds
+  /// @param memoryLimit Memory limit in megabytes
+  /// @param nrThreads Number of threads the solver can use
+  /// @param verbose Set to true to enable ILP solver output
+  bool solve(int timeLimit,
+             int memoryLimit,
+             int nrThreads,
+             bool verbose);
+  
+  /// Return results
+  const ResultVector& getResults() const
+  {
+    return _results;
+  }
+  
+  /// Write comma-separated summary with one line per number of losses,
+  /// including the cold objective value when verifying
+  ///
+  /// @param out Output stream
+  void writeSummary(std::ostream& out) const;
+  
+  /// Parse range 'a:b' or a single number, returns false if invalid
+  ///
+  /// @param str Range
+  /// @param minK Minimum number of losses per character
+  /// @param maxK Maximum number of losses per character
+  static bool parseRange(const std::string& str, int& minK, int& maxK);
+  
+private:
+  /// Minimum number of losses per character
+  const int _minK;
+  /// Maximum number of losses per character
+  const int _maxK;
+  /// Solver factory
+  SolverFactory _factory;
+  /// Indicates whether warm started solves are verified
+  bool _verify;
+  /// Results
+  ResultVector _results;
+};
+
+#endif // KSWEEP_H
@@ -0,0 +1,427 @@
+/*
+ * localsearch.cpp
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#include "localsearch.h"
+#include "greedydollo.h"
+#include <mutex>
+
+LocalSearch::LocalSearch(const Matrix& D,
+                         int k,
+                         double alpha,
+                         double beta)
+  : _D(D)
+  , _k(k)
+  , _m(D.getNrTaxa())
+  , _n(D.getNrCharacters())
+  , _gain(_m, StlDoubleVector(_n, 0))
+  , _baseL(0)
+  , _solA(_m, _n)
+  , _L(-std::numeric_limits<double>::max())
+{
+  const double log_alpha = log(alpha);
+  const double log_1_minus_alpha = log(1 - alpha);
+  const double log_beta = log(beta);
+  const double log_1_minus_beta = log(1 - beta);
+
+  for (int p = 0; p < _m; ++p)
+  {
+    for (int c = 0; c < _n; ++c)
+    {
+      int d_pc = _D.getEntry(p, c);
+      if (d_pc == 1)
+      {
+        _baseL += log_alpha;
+        _gain[p][c] = log_1_minus_alpha - log_alpha;
+      }
+      else if (d_pc != -1)
+      {
+        _baseL += log_1_minus_beta;
+        _gain[p][c] = log_beta - log_1_minus_beta;
+      }
+    }
+  }
+}
+
+void LocalSearch::initState(State& state) const
+{
+  GreedyDollo greedy(_D, _k);
+  greedy.solve();
+
+  const Matrix& A = greedy.getSolA();
+  state._parent = greedy.getCharacterParent();
+  state._placement = greedy.getTaxonPlacement();
+  state._nodeLoss = StlIntMatrix(_n);
+  state._leafLoss = StlIntMatrix(_m);
+  for (int p = 0; p < _m; ++p)
+  {
+    for (int c = 0; c < _n; ++c)
+    {
+      if (A.getEntry(p, c) >= 2)
+      {
+        state._leafLoss[p].push_back(c);
+      }
+    }
+  }
+  normalize(state);
+}
+
+StlIntMatrix LocalSearch::getChildren(const State& state) const
+{
+  StlIntMatrix children(_n + 1);
+  for (int c = 0; c < _n; ++c)
+  {
+    children[state._parent[c] == -1 ? _n : state._parent[c]].push_back(c);
+  }
+  return children;
+}
+
+void LocalSearch::normalize(State& state) const
+{
+  const StlIntMatrix children = getChildren(state);
+  StlIntMatrix taxa(_n + 1);
+  for (int p = 0; p < _m; ++p)
+  {
+    taxa[state._placement[p] == -1 ? _n : state._placement[p]].push_back(p);
+  }
+
+  // status is 0 if the character is absent, 1 if present and 2 if lost
+  StlIntVector status(_n, 0);
+  StlIntVector path;
+  state._nrLosses = StlIntVector(_n, 0);
+  state._score = 0;
+
+  // negative entries indicate exit of node ~u
+  StlIntVector stack(1, _n);
+  while (!stack.empty())
+  {
+    const int u = stack.back();
+    stack.pop_back();
+
+    if (u < 0)
+    {
+      for (int c : state._nodeLoss[~u])
+      {
+        status[c] = 1;
+      }
+      status[~u] = 0;
+      path.pop_back();
+      continue;
+    }
+
+    if (u != _n)
+    {
+      status[u] = 1;
+      path.push_back(u);
+
+      StlIntVector& nodeLoss = state._nodeLoss[u];
+      StlIntVector::iterator last = std::remove_if(nodeLoss.begin(), nodeLoss.end(),
+        [&](int c)
+        {
+          if (c == u || status[c] != 1 || state._nrLosses[c] == _k) return true;
+          status[c] = 2;
+          ++state._nrLosses[c];
+          return false;
+        });
+      nodeLoss.erase(last, nodeLoss.end());
+      stack.push_back(~u);
+    }
+
+    for (int p : taxa[u])
+    {
+      StlIntVector& leafLoss = state._leafLoss[p];
+      StlIntVector::iterator last = std::remove_if(leafLoss.begin(), leafLoss.end(),
+        [&](int c)
+        {
+          if (status[c] != 1 || state._nrLosses[c] == _k) return true;
+          status[c] = 2;
+          ++state._nrLosses[c];
+          return false;
+        });
+      leafLoss.erase(last, leafLoss.end());
+
+      for (int c : path)
+      {
+        if (status[c] == 1)
+        {
+          state._score += _gain[p][c];
+        }
+      }
+      for (int c : leafLoss)
+      {
+        status[c] = 1;
+      }
+    }
+
+    for (int v : children[u])
+    {
+      stack.push_back(v);
+    }
+  }
+}
+
+double LocalSearch::getRowScore(const State& state,
+                                int p,
+                                int v,
+                                bool leafLosses) const
+{
+  StlIntVector lost;
+  if (leafLosses)
+  {
+    lost = state._leafLoss[p];
+  }
+
+  double score = 0;
+  for (int u = v; u != -1; u = state._parent[u])
+  {
+    if (std::find(lost.begin(), lost.end(), u) == lost.end())
+    {
+      score += _gain[p][u];
+    }
+    lost.insert(lost.end(), state._nodeLoss[u].begin(), state._nodeLoss[u].end());
+  }
+  return score;
+}
+
+LocalSearch::State LocalSearch::runChain(int chain,
+                                         int nrIterations,
+                                         double temperature,
+                                         int timeLimit,
+                                         int seed) const
+{
+  std::mt19937 rng(seed + chain);
+  std::uniform_real_distribution<> unif(0, 1);
+  std::uniform_int_distribution<> randomTaxon(0, _m - 1);
+  std::uniform_int_distribution<> randomCharacter(0, _n - 1);
+  std::uniform_int_distribution<> randomNode(-1, _n - 1);
+
+  State state;
+  initState(state);
+  State best = state;
+
+  // geometric cooling down to a thousandth of the initial temperature
+  const double cooling = pow(1e-3, 1. / std::max(nrIterations, 1));
+  double T = temperature;
+
+  StlIntVector path;
+  for (int iteration = 0; iteration < nrIterations; ++iteration, T *= cooling)
+  {
+    if (timeLimit > 0 && iteration % 1024 == 0 && g_timer.realTime() > timeLimit)
+    {
+      break;
+    }
+
+    const double move = unif(rng);
+    if (move < 0.4)
+    {
+      // reattach taxon
+      const int p = randomTaxon(rng);
+      const int v = randomNode(rng);
+      const int u = state._placement[p];
+      if (v == u) continue;
+
+      double delta = getRowScore(state, p, v, false) - getRowScore(state, p, u, true);
+      if (delta >= 0 || unif(rng) < exp(delta / T))
+      {
+        for (int c : state._leafLoss[p])
+        {
+          --state._nrLosses[c];
+        }
+        state._leafLoss[p].clear();
+        state._placement[p] = v;
+        state._score += delta;
+      }
+    }
+    else if (move < 0.7)
+    {
+      // insert or delete loss on leaf edge
+      const int p = randomTaxon(rng);
+      path.clear();
+      for (int u = state._placement[p]; u != -1; u = state._parent[u])
+      {
+        path.push_back(u);
+      }
+      if (path.empty()) continue;
+
+      const int idx = std::uniform_int_distribution<>(0, path.size() - 1)(rng);
+      const int c = path[idx];
+      StlIntVector& leafLoss = state._leafLoss[p];
+      StlIntVector::iterator it = std::find(leafLoss.begin(), leafLoss.end(), c);
+      if (it != leafLoss.end())
+      {
+        double delta = _gain[p][c];
+        if (delta >= 0 || unif(rng) < exp(delta / T))
+        {
+          leafLoss.erase(it);
+          --state._nrLosses[c];
+          state._score += delta;
+        }
+      }
+      else if (state._nrLosses[c] < _k)
+      {
+        bool present = true;
+        for (int i = 0; i < idx && present; ++i)
+        {
+          const StlIntVector& nodeLoss = state._nodeLoss[path[i]];
+          present = std::find(nodeLoss.begin(), nodeLoss.end(), c) == nodeLoss.end();
+        }
+        if (!present) continue;
+
+        double delta = -_gain[p][c];
+        if (delta >= 0 || unif(rng) < exp(delta / T))
+        {
+          leafLoss.push_back(c);
+          ++state._nrLosses[c];
+          state._score += delta;
+        }
+      }
+    }
+    else
+    {
+      State candidate = state;
+      if (move < 0.9)
+      {
+        // subtree prune and regraft
+        const int x = randomCharacter(rng);
+        const int y = randomNode(rng);
+        if (y == state._parent[x] || (y != -1 && isDescendant(state, y, x))) continue;
+        candidate._parent[x] = y;
+      }
+      else
+      {
+        // insert or delete loss on edge into node
+        const int u = randomCharacter(rng);
+        path.clear();
+        for (int v = state._parent[u]; v != -1; v = state._parent[v])
+        {
+          path.push_back(v);
+        }
+        if (path.empty()) continue;
+
+        const int c = path[std::uniform_int_distribution<>(0, path.size() - 1)(rng)];
+        StlIntVector& nodeLoss = candidate._nodeLoss[u];
+        StlIntVector::iterator it = std::find(nodeLoss.begin(), nodeLoss.end(), c);
+        if (it != nodeLoss.end())
+        {
+          nodeLoss.erase(it);
+        }
+        else if (state._nrLosses[c] < _k)
+        {
+          nodeLoss.push_back(c);
+        }
+        else
+        {
+          continue;
+        }
+      }
+
+      normalize(candidate);
+      double delta = candidate._score - state._score;
+      if (delta >= 0 || unif(rng) < exp(delta / T))
+      {
+        std::swap(state, candidate);
+      }
+    }
+
+    if (g_tol.less(best._score, state._score))
+    {
+      best = state;
+    }
+  }
+
+  return best;
+}
+
+Matrix LocalSearch::getMatrix(const State& state) const
+{
+  const StlIntMatrix children = getChildren(state);
+  StlIntMatrix taxa(_n + 1);
+  for (int p = 0; p < _m; ++p)
+  {
+    taxa[state._placement[p] == -1 ? _n : state._placement[p]].push_back(p);
+  }
+
+  Matrix A(_m, _n);
+  StlIntVector current(_n, 0);
+  StlIntVector nextLossState(_n, 2);
+
+  StlIntVector stack(1, _n);
+  while (!stack.empty())
+  {
+    const int u = stack.back();
+    stack.pop_back();
+
+    if (u < 0)
+    {
+      for (int c : state._nodeLoss[~u])
+      {
+        current[c] = 1;
+      }
+      current[~u] = 0;
+      continue;
+    }
+
+    if (u != _n)
+    {
+      current[u] = 1;
+      for (int c : state._nodeLoss[u])
+      {
+        current[c] = nextLossState[c]++;
+      }
+      stack.push_back(~u);
+    }
+
+    for (int p : taxa[u])
+    {
+      for (int c = 0; c < _n; ++c)
+      {
+        A.setEntry(p, c, current[c]);
+      }
+      for (int c : state._leafLoss[p])
+      {
+        A.setEntry(p, c, nextLossState[c]++);
+      }
+    }
+
+    for (int v : children[u])
+    {
+      stack.push_back(v);
+    }
+  }
+
+  return A;
+}
+
+void LocalSearch::solve(int nrIterations,
+                        int nrChains,
+                        int nrThreads,
+                        double temperature,
+                        int timeLimit,
+                        int seed)
+{
+  std::vector<State> results(nrChains);
+  std::mutex mutex;
+  parallelForDynamic(nrChains, nrThreads, [&](int chain)
+  {
+    results[chain] = runChain(chain, nrIterations, temperature, timeLimit, seed);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::cerr << "Chain " << chain << " -- log likelihood "
+              << _baseL + results[chain]._score << std::endl;
+  });
+
+  int bestChain = 0;
+  for (int chain = 1; chain < nrChains; ++chain)
+  {
+    if (results[bestChain]._score < results[chain]._score)
+    {
+      bestChain = chain;
+    }
+  }
+
+  _solA = getMatrix(results[bestChain]);
+  _L = _baseL + results[bestChain]._score;
+}
@@ -0,0 +1,162 @@
+/*
+ * localsearch.h
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#ifndef LOCALSEARCH_H
+#define LOCALSEARCH_H
+
+#include <random>
+#include "utils.h"
+#include "matrix.h"
+
+/// This class provides a simulated annealing heuristic for the k-DPF problem
+/// that does not require an ILP solver.
+///
+/// A solution is a k-Dollo phylogeny in which every character is gained on
+/// the edge into its own node of a character tree, taxa are attached as leaves
+/// to nodes of this tree, and each character is lost at most k times on edges
+/// into nodes or leaves below its gain. Moves are taxon reattachment, subtree
+/// prune and regraft of characters and insertion/deletion of losses. The
+/// objective is the log likelihood of Matrix::getLogLikelihood. Independent
+/// chains are run in parallel, each starting from the GreedyDollo tree.
+class LocalSearch
+{
+public:
+  /// Constructor
+  ///
+  /// @param D Input matrix
+  /// @param k Maximum number of losses per character
+  /// @param alpha False positive rate
+  /// @param beta False negative rate
+  LocalSearch(const Matrix& D,
+              int k,
+              double alpha,
+              double beta);
+
+  /// Run independent annealing chains and keep the best solution
+  ///
+  /// @param nrIterations Number of moves per chain
+  /// @param nrChains Number of chains
+  /// @param nrThreads Number of threads
+  /// @param temperature Initial temperature
+  /// @param timeLimit Time limit in seconds
+  /// @param seed Random number generator seed
+  void solve(int nrIterations,
+             int nrChains,
+             int nrThreads,
+             double temperature,
+             int timeLimit,
+             int seed);
+
+  /// Return solution matrix
+  const Matrix& getSolA() const
+  {
+    return _solA;
+  }
+
+  /// Return log likelihood of solution matrix
+  double getLogLikelihood() const
+  {
+    return _L;
+  }
+
+private:
+  /// Solution of a single chain
+  struct State
+  {
+    /// Parent of each character, -1 for root
+    StlIntVector _parent;
+    /// Node of each taxon, -1 for root
+    StlIntVector _placement;
+    /// Characters lost on the edge into each node
+    StlIntMatrix _nodeLoss;
+    /// Characters lost on the edge into each leaf
+    StlIntMatrix _leafLoss;
+    /// Number of losses of each character
+    StlIntVector _nrLosses;
+    /// Sum of gains of present entries
+    double _score;
+  };
+
+  /// Initialize state from the greedy completion
+  ///
+  /// @param state State
+  void initState(State& state) const;
+
+  /// Run a single chain, returns best state encountered
+  ///
+  /// @param chain Chain index
+  /// @param nrIterations Number of moves
+  /// @param temperature Initial temperature
+  /// @param timeLimit Time limit in seconds
+  /// @param seed Random number generator seed
+  State runChain(int chain,
+                 int nrIterations,
+                 double temperature,
+                 int timeLimit,
+                 int seed) const;
+
+  /// Remove losses that are not below the gain of their character or that
+  /// are below another loss of the same character, and recompute score
+  ///
+  /// @param state State
+  void normalize(State& state) const;
+
+  /// Return sum of gains of present entries of taxon p when placed at node v
+  ///
+  /// @param state State
+  /// @param p Taxon
+  /// @param v Node
+  /// @param leafLosses Account for losses on the leaf edge of p
+  double getRowScore(const State& state,
+                     int p,
+                     int v,
+                     bool leafLosses) const;
+
+  /// Return whether node u is in the subtree rooted at node x
+  ///
+  /// @param state State
+  /// @param u Node
+  /// @param x Node
+  static bool isDescendant(const State& state, int u, int x)
+  {
+    for (; u != -1; u = state._parent[u])
+    {
+      if (u == x) return true;
+    }
+    return false;
+  }
+
+  /// Return k-Dollo completion of state
+  ///
+  /// @param state State
+  Matrix getMatrix(const State& state) const;
+
+  /// Return children lists of the character tree, index n is the root
+  ///
+  /// @param state State
+  StlIntMatrix getChildren(const State& state) const;
+
+private:
+  /// Input matrix
+  const Matrix& _D;
+  /// Maximum number of losses per character
+  const int _k;
+  /// Number of taxa
+  const int _m;
+  /// Number of characters
+  const int _n;
+  /// _gain[p][c] is the log likelihood gain of entry (p,c) being present
+  std::vector<StlDoubleVector> _gain;
+  /// Log likelihood when all entries are absent
+  double _baseL;
+  /// Solution matrix
+  Matrix _solA;
+  /// Log likelihood of solution matrix
+  double _L;
+};
+
+#endif // LOCALSEARCH_H
@@ -6,6 +6,8 @@
  */
 
 #include "matrix.h"
+#include "budget.h"
+#include "forbiddenpatterns.h"
 #include <random>
 
 Matrix::Matrix()
@@ -162,10 +164,16 @@ void Matrix::identifyRepeatedRows(StlIntVector& taxonMapping) const
 
 
 Matrix Matrix::simplify(StlIntVector& characterMapping,
-                        StlIntVector& taxonMapping) const
+                        StlIntVector& taxonMapping,
+                        Budget* budget) const
 {
   Matrix newB = simplifyColumns(characterMapping);
   newB = newB.simplifyRows(taxonMapping);
+  if (budget)
+  {
+    // both passes are linear, so the budget is charged but not polled
+    budget->tick(2. * _m * _n);
+  }
   
   return newB;
 }
@@ -442,103 +450,67 @@ void Matrix::perturb(double alpha, double beta, int seed)
 void Matrix::identifyViolations(int k,
                                 ViolationList& violationList) const
 {
-  for (int p = 0; p < _m; ++p)
+  identifyViolations(k, [&violationList](const Violation& violation)
+  {
+    violationList.push_back(violation);
+    return true;
+  });
+}
+
+long long Matrix::countViolations(int k) const
+{
+  long long res = 0;
+  identifyViolations(k, [&res](const Violation&)
+  {
+    ++res;
+    return true;
+  });
+  return res;
+}
+
+bool Matrix::identifyViolations(int k,
+                                const ViolationHandler& handler) const
+{
+  // taxa whose states in characters c and d are s_c and s_d
+  auto collect = [this](int c, int s_c, int d, int s_d, StlIntVector& rows)
   {
-    for (int q = 0; q < _m; ++q)
+    rows.clear();
+    for (int p = 0; p < _m; ++p)
+    {
+      if (_D[p][c] == s_c && _D[p][d] == s_d)
+      {
+        rows.push_back(p);
+      }
+    }
+  };
+  
+  // the rows of a pattern differ in state, so p, q and r are distinct
+  StlIntVector P, Q, R;
+  return forEachForbiddenPattern(k, _n,
+                                 [](int, int) { return true; },
+                                 [&](int c, int d, const ForbiddenPattern& pattern)
+  {
+    collect(c, pattern._pc, d, pattern._pd, P);
+    if (P.empty()) return true;
+    collect(c, pattern._qc, d, pattern._qd, Q);
+    if (Q.empty()) return true;
+    collect(c, pattern._rc, d, pattern._rd, R);
+    
+    for (int p : P)
     {
-      if (q == p) continue;
-      for (int r = 0; r < _m; ++r)
+      for (int q : Q)
       {
-        if (r == p || r == q) continue;
-        for (int c = 0; c < _n; ++c)
+        for (int r : R)
         {
-          for (int d = c + 1; d < _n; ++d)
+          if (!handler(Violation(c, d, p, q, r, pattern._condition)))
           {
-            // condition 1
-            for (int i = 1; i <= k + 1; ++i)
-            {
-              for (int i_prime = 1; i_prime <= k + 1; ++i_prime)
-              {
-                for (int j = 1; j <= k + 1; ++j)
-                {
-                  for (int j_prime = 1; j_prime <= k + 1; ++j_prime)
-                  {
-                    if (_D[p][c] == i && _D[q][c] == 0 && _D[r][c] == i_prime
-                        && _D[p][d] == 0 && _D[q][d] == j && _D[r][d] == j_prime)
-                    {
-                      violationList.push_back(Violation(c, d, p, q, r, 1));
-                    }
-                  }
-                }
-              }
-            }
-            
-            // condition 2
-            for (int i = 1; i <= k + 1; ++i)
-            {
-              for (int i_prime = 1; i_prime <= k + 1; ++i_prime)
-              {
-                for (int j = 2; j <= k + 1; ++j)
-                {
-                  for (int j_prime = 1; j_prime <= k + 1; ++j_prime)
-                  {
-                    if (j_prime == j) continue;
-                
-                    if (_D[p][c] == i && _D[q][c] == 0 && _D[r][c] == i_prime
-                        && _D[p][d] == j_prime && _D[q][d] == j && _D[r][d] == j)
-                    {
-                      violationList.push_back(Violation(c, d, p, q, r, 2));
-                    }
-                  }
-                }
-              }
-            }
-  
-            // condition 3
-            for (int i = 2; i <= k + 1; ++i)
-            {
-              for (int i_prime = 1; i_prime <= k + 1; ++i_prime)
-              {
-                if (i_prime == i) continue;
-                for (int j = 1; j <= k + 1; ++j)
-                {
-                  for (int j_prime = 1; j_prime <= k + 1; ++j_prime)
-                  {
-                    if (_D[p][c] == i && _D[q][c] == i_prime && _D[r][c] == i
-                        && _D[p][d] == 0 && _D[q][d] == j && _D[r][d] == j_prime)
-                    {
-                      violationList.push_back(Violation(c, d, p, q, r, 3));
-                    }
-                  }
-                }
-              }
-            }
-            
-            // condition 4
-            for (int i = 2; i <= k + 1; ++i)
-            {
-              for (int i_prime = 1; i_prime <= k + 1; ++i_prime)
-              {
-                if (i_prime == i) continue;
-                for (int j = 2; j <= k + 1; ++j)
-                {
-                  for (int j_prime = 1; j_prime <= k + 1; ++j_prime)
-                  {
-                    if (j_prime == j) continue;
-                    if (_D[p][c] == i && _D[q][c] == i_prime && _D[r][c] == i
-                        && _D[p][d] == j_prime && _D[q][d] == j && _D[r][d] == j)
-                    {
-                      violationList.push_back(Violation(c, d, p, q, r, 4));
-                    }
-                  }
-                }
-              }
-            }
+            return false;
           }
         }
       }
     }
-  }
+    return true;
+  });
 }
 
 std::ostream& operator<<(std::ostream& out, const Matrix& D)
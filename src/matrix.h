@@ -10,6 +10,9 @@
 
 #include "utils.h"
 #include <list>
+#include <functional>
+
+class Budget;
 
 /// This class models a (k-Dollo) completion matrix
 class Matrix
@@ -203,6 +206,9 @@ public:
   /// List of forbidden submatrices
   typedef std::list<Violation> ViolationList;
   
+  /// Function called for each forbidden submatrix, returns false to stop
+  typedef std::function<bool(const Violation&)> ViolationHandler;
+  
   /// Identfies forbidden submatrices
   ///
   /// @param k Maximum number of character losses
@@ -210,6 +216,21 @@ public:
   void identifyViolations(int k,
                           ViolationList& violationList) const;
   
+  /// Enumerates forbidden submatrices without storing them. Violations are
+  /// grouped by character pair (c, d), in lexicographic order, and then by
+  /// forbidden pattern, see forbiddenpatterns.h. Returns false if the handler
+  /// stopped the enumeration.
+  ///
+  /// @param k Maximum number of character losses
+  /// @param handler Function called for each forbidden submatrix
+  bool identifyViolations(int k,
+                          const ViolationHandler& handler) const;
+  
+  /// Return number of forbidden submatrices
+  ///
+  /// @param k Maximum number of character losses
+  long long countViolations(int k) const;
+  
   /// Identifies repeated characters (columns)
   ///
   /// @param characterMapping Cluster assignment of original characters
@@ -224,8 +245,10 @@ public:
   ///
   /// @param characterMapping Cluster assignment of original characters
   /// @param taxonMapping Cluster assignment of original taxa
+  /// @param budget Budget charged for the work, may be NULL
   Matrix simplify(StlIntVector& characterMapping,
-                  StlIntVector& taxonMapping) const;
+                  StlIntVector& taxonMapping,
+                  Budget* budget = NULL) const;
   
   /// Return new matrix with removed repeated and redundant characters
   ///
@@ -0,0 +1,316 @@
+/*
+ * microbenchmain.cpp
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#include <sstream>
+#include <random>
+#include <benchmark/benchmark.h>
+#include "matrix.h"
+#include "cluster.h"
+#include "coordinateascent.h"
+#include "columngen.h"
+
+/// Generate a k-Dollo completion matrix
+///
+/// Characters are organized in a random mutation tree, each taxon is attached
+/// to a random node of that tree. Each present character is lost with
+/// probability lossRate, yielding a random loss state in {2, ..., k+1}.
+///
+/// @param m Number of taxa
+/// @param n Number of characters
+/// @param k Maximum number of losses per character
+/// @param lossRate Probability of a loss
+/// @param seed Random number generator seed
+Matrix generateCompletion(int m, int n, int k,
+                          double lossRate, int seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<> unif(0, 1);
+
+  StlIntVector parent(n, -1);
+  for (int c = 1; c < n; ++c)
+  {
+    parent[c] = std::uniform_int_distribution<>(0, c - 1)(rng);
+  }
+
+  Matrix A(m, n);
+  for (int p = 0; p < m; ++p)
+  {
+    for (int c = 0; c < n; ++c)
+    {
+      A.setEntry(p, c, 0);
+    }
+    int c = std::uniform_int_distribution<>(0, n - 1)(rng);
+    while (c != -1)
+    {
+      int state = 1;
+      if (k > 0 && unif(rng) < lossRate)
+      {
+        state = std::uniform_int_distribution<>(2, k + 1)(rng);
+      }
+      A.setEntry(p, c, state);
+      c = parent[c];
+    }
+  }
+
+  return A;
+}
+
+/// Generate an observed binary matrix with missing entries
+///
+/// @param m Number of taxa
+/// @param n Number of characters
+/// @param k Maximum number of losses per character
+/// @param missingRate Probability of a missing entry
+/// @param seed Random number generator seed
+Matrix generateObserved(int m, int n, int k,
+                        double missingRate, int seed)
+{
+  Matrix B = generateCompletion(m, n, k, 0.1, seed);
+
+  std::mt19937 rng(seed + 1);
+  std::uniform_real_distribution<> unif(0, 1);
+  for (int p = 0; p < m; ++p)
+  {
+    for (int c = 0; c < n; ++c)
+    {
+      if (unif(rng) < missingRate)
+      {
+        B.setEntry(p, c, -1);
+      }
+      else
+      {
+        B.setEntry(p, c, B.getEntry(p, c) == 1 ? 1 : 0);
+      }
+    }
+  }
+
+  return B;
+}
+
+/// Coordinate ascent exposing the cluster assignment steps
+class CoordinateAscentBench : public CoordinateAscent
+{
+public:
+  CoordinateAscentBench(const Matrix& D,
+                        const StlIntVector& characterMapping,
+                        const StlIntVector& taxonMapping,
+                        int k,
+                        int s,
+                        int t)
+    : CoordinateAscent(D, characterMapping, taxonMapping,
+                       k, true, 1e-3, 0.2, s, t, 0)
+  {
+    initZ(0);
+    _E = generateCompletion(_s, _t, _k, 0.1, 0);
+  }
+
+  using CoordinateAscent::solveZT;
+  using CoordinateAscent::solveZC;
+};
+
+/// Column generation exposing the separation kernel
+class ColumnGenBench : public ColumnGen
+{
+public:
+  using ColumnGen::ViolatedConstraintList;
+  using ColumnGen::getIndex;
+  using ColumnGen::identifyViolatedConstraints;
+};
+
+static void setItems(benchmark::State& state, int m, int n)
+{
+  state.SetItemsProcessed(state.iterations() * int64_t(m) * n);
+}
+
+static void BM_Simplify(benchmark::State& state)
+{
+  const int m = state.range(0);
+  const int n = state.range(1);
+  Matrix B = generateObserved(m, n, state.range(2), state.range(3) / 100., 0);
+
+  for (auto _ : state)
+  {
+    StlIntVector characterMapping, taxonMapping;
+    benchmark::DoNotOptimize(B.simplify(characterMapping, taxonMapping));
+  }
+  setItems(state, m, n);
+}
+
+static void BM_IdentifyViolations(benchmark::State& state)
+{
+  const int m = state.range(0);
+  const int n = state.range(1);
+  const int k = state.range(2);
+  Matrix A = generateCompletion(m, n, k, state.range(3) / 100., 0);
+
+  long long nrViolations = 0;
+  for (auto _ : state)
+  {
+    nrViolations = A.countViolations(k);
+  }
+  state.counters["violations"] = nrViolations;
+  setItems(state, m, n);
+}
+
+static void BM_ParseMatrix(benchmark::State& state)
+{
+  const int m = state.range(0);
+  const int n = state.range(1);
+  Matrix B = generateObserved(m, n, state.range(2), state.range(3) / 100., 0);
+
+  std::stringstream ss;
+  ss << B;
+  const std::string str = ss.str();
+
+  for (auto _ : state)
+  {
+    std::istringstream in(str);
+    Matrix D;
+    in >> D;
+    benchmark::DoNotOptimize(D.getNrTaxa());
+  }
+  setItems(state, m, n);
+  state.SetBytesProcessed(state.iterations() * int64_t(str.size()));
+}
+
+static void BM_Cluster(benchmark::State& state)
+{
+  const int m = state.range(0);
+  const int n = state.range(1);
+  Matrix B = generateObserved(m, n, state.range(2), state.range(3) / 100., 0);
+
+  int seed = 0;
+  for (auto _ : state)
+  {
+    Cluster cluster(B, 10, 15);
+    cluster.cluster(seed++);
+    benchmark::DoNotOptimize(cluster.getTaxonMapping().data());
+  }
+  setItems(state, m, n);
+}
+
+static void BM_SolveZT(benchmark::State& state)
+{
+  const int m = state.range(0);
+  const int n = state.range(1);
+  const int k = state.range(2);
+  Matrix B = generateObserved(m, n, k, state.range(3) / 100., 0);
+
+  StlIntVector characterMapping(n), taxonMapping(m);
+  for (int c = 0; c < n; ++c) characterMapping[c] = c;
+  for (int p = 0; p < m; ++p) taxonMapping[p] = p;
+  CoordinateAscentBench ca(B, characterMapping, taxonMapping, k, 10, 15);
+
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(ca.solveZT());
+  }
+  setItems(state, m, n);
+}
+
+static void BM_SolveZC(benchmark::State& state)
+{
+  const int m = state.range(0);
+  const int n = state.range(1);
+  const int k = state.range(2);
+  Matrix B = generateObserved(m, n, k, state.range(3) / 100., 0);
+
+  StlIntVector characterMapping(n), taxonMapping(m);
+  for (int c = 0; c < n; ++c) characterMapping[c] = c;
+  for (int p = 0; p < m; ++p) taxonMapping[p] = p;
+  CoordinateAscentBench ca(B, characterMapping, taxonMapping, k, 10, 15);
+
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(ca.solveZC());
+  }
+  setItems(state, m, n);
+}
+
+static void BM_Separate(benchmark::State& state)
+{
+  const int m = state.range(0);
+  const int n = state.range(1);
+  const int k = state.range(2);
+  Matrix A = generateCompletion(m, n, k, state.range(3) / 100., 0);
+
+  StlDoubleVector vals(m * n * (k + 2), 0.);
+  for (int p = 0; p < m; ++p)
+  {
+    for (int c = 0; c < n; ++c)
+    {
+      vals[ColumnGenBench::getIndex(n, k, p, c, A.getEntry(p, c))] = 1.;
+    }
+  }
+
+  size_t nrConstraints = 0;
+  for (auto _ : state)
+  {
+    ColumnGenBench::ViolatedConstraintList constraints;
+    ColumnGenBench::identifyViolatedConstraints(m, n, k, vals, constraints);
+    nrConstraints = constraints.size();
+  }
+  state.counters["constraints"] = nrConstraints;
+  setItems(state, m, n);
+}
+
+// arguments: m, n, k, missing (or loss) rate in percent
+static void matrixArgs(benchmark::internal::Benchmark* b)
+{
+  b->ArgNames({"m", "n", "k", "rate"});
+  for (int m : {50, 200, 1000})
+  {
+    for (int n : {50, 200})
+    {
+      for (int rate : {0, 20})
+      {
+        b->Args({m, n, 1, rate});
+      }
+    }
+  }
+}
+
+// brute force enumeration is cubic in m and quadratic in n, keep instances small
+static void violationArgs(benchmark::internal::Benchmark* b)
+{
+  b->ArgNames({"m", "n", "k", "rate"});
+  for (int m : {10, 25})
+  {
+    for (int k : {1, 2})
+    {
+      for (int rate : {0, 5})
+      {
+        b->Args({m, 25, k, rate});
+      }
+    }
+  }
+}
+
+static void separationArgs(benchmark::internal::Benchmark* b)
+{
+  b->ArgNames({"m", "n", "k", "rate"});
+  for (int m : {25, 50, 100})
+  {
+    for (int k : {1, 2})
+    {
+      for (int rate : {0, 1})
+      {
+        b->Args({m, 50, k, rate});
+      }
+    }
+  }
+}
+
+BENCHMARK(BM_Simplify)->Apply(matrixArgs);
+BENCHMARK(BM_ParseMatrix)->Apply(matrixArgs);
+BENCHMARK(BM_Cluster)->Apply(matrixArgs);
+BENCHMARK(BM_SolveZT)->Apply(matrixArgs);
+BENCHMARK(BM_SolveZC)->Apply(matrixArgs);
+BENCHMARK(BM_IdentifyViolations)->Apply(violationArgs);
+BENCHMARK(BM_Separate)->Apply(separationArgs);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,58 @@
+/*
+ * mipbackend.cpp
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#include "mipbackend.h"
+#include <algorithm>
+#ifdef HAVE_CPLEX
+#include "cplexbackend.h"
+#endif // HAVE_CPLEX
+#ifdef HAVE_HIGHS
+#include "highsbackend.h"
+#endif // HAVE_HIGHS
+
+constexpr double MipBackend::INF;
+
+MipBackend* MipBackend::create(const std::string& name)
+{
+#ifdef HAVE_CPLEX
+  if (name == "cplex")
+  {
+    return new CplexBackend();
+  }
+#endif // HAVE_CPLEX
+#ifdef HAVE_HIGHS
+  if (name == "highs")
+  {
+    return new HighsBackend();
+  }
+#endif // HAVE_HIGHS
+  return NULL;
+}
+
+StringVector MipBackend::getAvailableBackends()
+{
+  StringVector res;
+#ifdef HAVE_CPLEX
+  res.push_back("cplex");
+#endif // HAVE_CPLEX
+#ifdef HAVE_HIGHS
+  res.push_back("highs");
+#endif // HAVE_HIGHS
+  return res;
+}
+
+bool MipBackend::isAvailable(const std::string& name)
+{
+  StringVector backends = getAvailableBackends();
+  return std::find(backends.begin(), backends.end(), name) != backends.end();
+}
+
+std::string MipBackend::getDefaultBackend()
+{
+  StringVector backends = getAvailableBackends();
+  return backends.empty() ? "" : backends.front();
+}
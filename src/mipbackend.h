@@ -0,0 +1,177 @@
+/*
+ * mipbackend.h
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#ifndef MIPBACKEND_H
+#define MIPBACKEND_H
+
+#include <limits>
+#include <functional>
+#include "utils.h"
+#include "solverprofile.h"
+
+/// This class provides a minimal interface to a MIP solver.
+///
+/// Variables are binary and identified by the order in which they were added.
+/// Rows are of the form lb <= sum_i coefs[i] * x[vars[i]] <= ub, where vars
+/// has no duplicates. Implementations are only available if the
+/// corresponding solver was found at build time (HAVE_CPLEX, HAVE_HIGHS).
+class MipBackend
+{
+public:
+  /// Row lb <= sum_i _coefs[i] * x[_vars[i]] <= ub
+  struct Row
+  {
+    /// Variables
+    StlIntVector _vars;
+    /// Coefficients
+    StlDoubleVector _coefs;
+    /// Lower bound
+    double _lb;
+    /// Upper bound
+    double _ub;
+  };
+
+  typedef std::vector<Row> RowVector;
+
+  /// Handler receiving the variable values of every new incumbent, may be
+  /// called from solver threads
+  typedef std::function<void(const StlDoubleVector& vals)> IncumbentCallback;
+
+  /// Separator appending rows violated by the given, possibly fractional,
+  /// variable values to rows, may be called from solver threads
+  typedef std::function<void(const StlDoubleVector& vals, RowVector& rows)> SeparationCallback;
+
+  /// Infinite bound
+  static constexpr double INF = std::numeric_limits<double>::infinity();
+
+  /// Destructor
+  virtual ~MipBackend()
+  {
+  }
+
+  /// Construct backend. Returns NULL if the backend is not available.
+  ///
+  /// @param name Backend name ("cplex" or "highs")
+  static MipBackend* create(const std::string& name);
+
+  /// Return names of backends available in this build
+  static StringVector getAvailableBackends();
+
+  /// Return name of default backend, empty if none is available
+  static std::string getDefaultBackend();
+  
+  /// Return whether the given backend is available in this build
+  ///
+  /// @param name Backend name
+  static bool isAvailable(const std::string& name);
+
+  /// Add binary variable and return its index
+  ///
+  /// @param name Variable name
+  virtual int addBinaryVariable(const std::string& name) = 0;
+
+  /// Return number of variables
+  virtual int getNrVariables() const = 0;
+
+  /// Set upper bound of variable
+  ///
+  /// @param var Variable
+  /// @param ub Upper bound
+  virtual void setUpperBound(int var, double ub) = 0;
+
+  /// Add row to the model
+  ///
+  /// @param row Row
+  virtual void addRow(const Row& row) = 0;
+
+  /// Add rows to the lazy constraint pool, backends without such a pool add
+  /// them to the model
+  ///
+  /// @param rows Rows
+  virtual void addLazyRows(const RowVector& rows) = 0;
+
+  /// Return number of rows of the model
+  virtual int getNrRows() const = 0;
+
+  /// Set callback that receives every new incumbent during solve
+  ///
+  /// @param callback Incumbent callback
+  virtual void setIncumbentCallback(const IncumbentCallback& callback) = 0;
+
+  /// Set callback that separates lazy constraints during solve. Solutions
+  /// violating a separated row are rejected, backends may additionally add
+  /// rows separated from fractional values as cuts.
+  ///
+  /// @param callback Separation callback
+  virtual void setSeparationCallback(const SeparationCallback& callback) = 0;
+
+  /// Set objective function, replacing the previous one
+  ///
+  /// @param coefs Coefficient of each variable
+  /// @param constant Constant term
+  /// @param maximize Maximize if true, minimize otherwise
+  virtual void setObjective(const StlDoubleVector& coefs,
+                            double constant,
+                            bool maximize) = 0;
+
+  /// Add MIP start
+  ///
+  /// @param vars Variables
+  /// @param vals Values
+  virtual void addMIPStart(const StlIntVector& vars,
+                           const StlDoubleVector& vals) = 0;
+
+  /// Set solver parameters
+  ///
+  /// @param timeLimit Time limit in seconds, unlimited if non-positive
+  /// @param memoryLimit Memory limit in megabytes, unlimited if non-positive
+  /// @param nrThreads Number of threads, solver default if non-positive
+  /// @param verbose Enable solver output
+  virtual void setParameters(int timeLimit,
+                             int memoryLimit,
+                             int nrThreads,
+                             bool verbose) = 0;
+
+  /// Apply solver profile, parameters the backend does not support are
+  /// ignored
+  ///
+  /// @param profile Solver profile
+  virtual void setProfile(const SolverProfile& profile) = 0;
+
+  /// Set deterministic time limit of the next solve in solver-specific ticks
+  ///
+  /// @param ticks Deterministic time limit, unlimited if negative
+  virtual void setDeterministicTimeLimit(double ticks) = 0;
+  
+  /// Return deterministic time spent by the last solve, 0 if the solver
+  /// does not measure deterministic time
+  virtual double getDeterministicTime() const = 0;
+
+  /// Solve model, returns true if optimality was proven
+  virtual bool solve() = 0;
+
+  /// Return whether the last solve found a solution satisfying all rows,
+  /// including the separated ones
+  virtual bool hasSolution() const = 0;
+
+  /// Return values of all variables of the last solution
+  ///
+  /// @param vals Output values
+  virtual void getValues(StlDoubleVector& vals) const = 0;
+
+  /// Return objective value of the last solution
+  virtual double getObjValue() const = 0;
+
+  /// Return best objective bound of the last solve
+  virtual double getBestObjValue() const = 0;
+
+  /// Abort the current and all subsequent solves, may be called from
+  /// another thread
+  virtual void abort() = 0;
+};
+
+#endif // MIPBACKEND_H
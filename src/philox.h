@@ -0,0 +1,69 @@
+/*
+ * philox.h
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <array>
+#include <cstdint>
+
+/// This class models the Philox4x32-10 counter-based random number generator
+/// (Salmon et al., SC 2011). Each output is a pure function of a key and a
+/// counter, so cells of a matrix can be drawn independently and in any order.
+class Philox4x32
+{
+public:
+  typedef std::array<uint32_t, 4> Counter;
+  typedef std::array<uint32_t, 2> Key;
+
+  /// Constructor
+  ///
+  /// @param seed Random number generator seed
+  /// @param stream Stream identifier
+  Philox4x32(uint32_t seed, uint32_t stream = 0)
+    : _key({{seed, stream}})
+  {
+  }
+
+  /// Return the random 128-bit block for the given counter
+  ///
+  /// @param ctr Counter
+  Counter operator()(Counter ctr) const
+  {
+    Key key = _key;
+    for (int round = 0; round < 10; ++round)
+    {
+      if (round > 0)
+      {
+        key[0] += 0x9E3779B9;
+        key[1] += 0xBB67AE85;
+      }
+      const uint64_t prod0 = uint64_t(0xD2511F53) * ctr[0];
+      const uint64_t prod1 = uint64_t(0xCD9E8D57) * ctr[2];
+      ctr = {{uint32_t(prod1 >> 32) ^ ctr[1] ^ key[0], uint32_t(prod1),
+              uint32_t(prod0 >> 32) ^ ctr[3] ^ key[1], uint32_t(prod0)}};
+    }
+    return ctr;
+  }
+
+  /// Return a uniform draw from [0,1) for the given pair of indices
+  ///
+  /// @param i First index (e.g. taxon)
+  /// @param j Second index (e.g. character)
+  double uniform(uint32_t i, uint32_t j) const
+  {
+    Counter r = (*this)({{i, j, 0, 0}});
+    uint64_t bits = (uint64_t(r[0]) << 32) | r[1];
+    return (bits >> 11) * (1.0 / 9007199254740992.0);
+  }
+
+private:
+  /// Key
+  const Key _key;
+};
+
+#endif // PHILOX_H
@@ -6,44 +6,288 @@
  */
 
 #include "phylogenetictree.h"
+#include <cstring>
+#include <limits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const char* const PhylogeneticTree::BINARY_MAGIC = "SPHYRBT1";
 
 PhylogeneticTree::PhylogeneticTree()
   : _T()
   , _root(_T.addNode())
-  , _b(_T)
+  , _n(0)
+  , _rootState()
   , _charStateLabeling(_T)
   , _charStateVectorLabeling(_T)
   , _taxonToLeaf()
   , _leafToTaxon(_T, -1)
+  , _leafB()
 {
 }
 
 PhylogeneticTree* PhylogeneticTree::parse(const std::string& filename)
 {
   PhylogeneticTree* pTree = NULL;
+  const size_t magicSize = strlen(BINARY_MAGIC);
   
   if (filename == "-")
   {
+    // standard input cannot be mapped, buffer it to detect the format
+    std::string buffer((std::istreambuf_iterator<char>(std::cin)),
+                       std::istreambuf_iterator<char>());
+    
     pTree = new PhylogeneticTree();
-    std::cin >> *pTree;
+    if (buffer.compare(0, magicSize, BINARY_MAGIC) == 0)
+    {
+      pTree->readBinary(buffer.data(), buffer.size());
+    }
+    else
+    {
+      std::istringstream inT(buffer);
+      inT >> *pTree;
+    }
+    
+    return pTree;
   }
-  else
+  
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd == -1)
+  {
+    std::cerr << "Error: could not open '" << filename << "' for reading" << std::endl;
+    return NULL;
+  }
+  
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size >= (off_t)magicSize)
   {
-    std::ifstream inT(filename.c_str());
-    if (!inT.good())
+    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED)
     {
-      std::cerr << "Error: could not open '" << filename << "' for reading" << std::endl;
-      return NULL;
+      if (memcmp(data, BINARY_MAGIC, magicSize) == 0)
+      {
+        pTree = new PhylogeneticTree();
+        try
+        {
+          pTree->readBinary(static_cast<const char*>(data), st.st_size);
+        }
+        catch (...)
+        {
+          munmap(data, st.st_size);
+          close(fd);
+          delete pTree;
+          throw;
+        }
+      }
+      munmap(data, st.st_size);
     }
-    
-    pTree = new PhylogeneticTree();
-    inT >> *pTree;
-    inT.close();
+  }
+  close(fd);
+  
+  if (pTree)
+  {
+    return pTree;
   }
   
+  std::ifstream inT(filename.c_str());
+  if (!inT.good())
+  {
+    std::cerr << "Error: could not open '" << filename << "' for reading" << std::endl;
+    return NULL;
+  }
+  
+  pTree = new PhylogeneticTree();
+  inT >> *pTree;
+  inT.close();
+  
   return pTree;
 }
 
+void PhylogeneticTree::writeBinary(std::ostream& out) const
+{
+  CsrTree tree;
+  buildCsr(tree);
+  
+  const uint32_t nrNodes = tree.size();
+  std::vector<int32_t> taxon(nrNodes, -1);
+  std::vector<uint32_t> offset(nrNodes + 1, 0);
+  std::vector<int32_t> changes;
+  
+  for (int c = 0; c < _n; ++c)
+  {
+    if (_rootState[c] != 0)
+    {
+      changes.push_back(c);
+      changes.push_back(_rootState[c]);
+    }
+  }
+  offset[1] = changes.size() / 2;
+  
+  for (uint32_t i = 1; i < nrNodes; ++i)
+  {
+    if (tree.isLeaf(i))
+    {
+      taxon[i] = _leafToTaxon[tree._node[i]];
+    }
+    for (const IntPair& ci : _charStateLabeling[tree._inArc[i]])
+    {
+      changes.push_back(ci.first);
+      changes.push_back(ci.second);
+    }
+    offset[i + 1] = changes.size() / 2;
+  }
+  
+  const uint32_t header[3] = {nrNodes, uint32_t(_taxonToLeaf.size()), uint32_t(_n)};
+  const std::vector<int32_t> parent(tree._parent.begin(), tree._parent.end());
+  
+  out.write(BINARY_MAGIC, strlen(BINARY_MAGIC));
+  out.write(reinterpret_cast<const char*>(header), sizeof(header));
+  out.write(reinterpret_cast<const char*>(parent.data()), nrNodes * sizeof(int32_t));
+  out.write(reinterpret_cast<const char*>(taxon.data()), nrNodes * sizeof(int32_t));
+  out.write(reinterpret_cast<const char*>(offset.data()), (nrNodes + 1) * sizeof(uint32_t));
+  out.write(reinterpret_cast<const char*>(changes.data()), changes.size() * sizeof(int32_t));
+}
+
+void PhylogeneticTree::readBinary(const char* data, size_t size)
+{
+  size_t pos = 0;
+  auto read = [&](void* dest, size_t bytes)
+  {
+    if (size - pos < bytes)
+    {
+      throw std::runtime_error("Error: unexpected end of binary tree.");
+    }
+    memcpy(dest, data + pos, bytes);
+    pos += bytes;
+  };
+  
+  const size_t magicSize = strlen(BINARY_MAGIC);
+  if (size < magicSize || memcmp(data, BINARY_MAGIC, magicSize) != 0)
+  {
+    throw std::runtime_error("Error: invalid binary tree magic string.");
+  }
+  pos = magicSize;
+  
+  uint32_t header[3];
+  read(header, sizeof(header));
+  const uint32_t nrNodes = header[0];
+  const uint32_t nrTaxa = header[1];
+  const uint32_t n = header[2];
+  if (nrNodes == 0)
+  {
+    throw std::runtime_error("Error: number of nodes should be positive.");
+  }
+  // validate the header against the remaining data before allocating, every
+  // node takes a parent, a taxon and an offset, followed by one more offset
+  if (size - pos < sizeof(uint32_t)
+      || nrNodes > (size - pos - sizeof(uint32_t)) / (3 * sizeof(int32_t)))
+  {
+    throw std::runtime_error("Error: unexpected end of binary tree.");
+  }
+  if (nrTaxa > nrNodes)
+  {
+    throw std::runtime_error("Error: number of taxa exceeds number of nodes.");
+  }
+  if (n > static_cast<uint32_t>(std::numeric_limits<int32_t>::max()))
+  {
+    throw std::runtime_error("Error: invalid number of characters.");
+  }
+  
+  const size_t nrOffsets = static_cast<size_t>(nrNodes) + 1;
+  std::vector<int32_t> parent(nrNodes), taxon(nrNodes);
+  std::vector<uint32_t> offset(nrOffsets);
+  read(parent.data(), nrNodes * sizeof(int32_t));
+  read(taxon.data(), nrNodes * sizeof(int32_t));
+  read(offset.data(), nrOffsets * sizeof(uint32_t));
+  for (uint32_t i = 0; i < nrNodes; ++i)
+  {
+    if (offset[i] > offset[i + 1])
+    {
+      throw std::runtime_error("Error: invalid change list offsets.");
+    }
+  }
+  if (offset[0] != 0 || offset[nrNodes] > (size - pos) / (2 * sizeof(int32_t)))
+  {
+    throw std::runtime_error("Error: invalid change list offsets.");
+  }
+  std::vector<int32_t> changes(2 * offset[nrNodes]);
+  read(changes.data(), changes.size() * sizeof(int32_t));
+  
+  _T.clear();
+  NodeVector nodes(nrNodes, lemon::INVALID);
+  for (uint32_t i = 0; i < nrNodes; ++i)
+  {
+    nodes[i] = _T.addNode();
+    _leafToTaxon[nodes[i]] = -1;
+  }
+  
+  if (parent[0] != -1)
+  {
+    throw std::runtime_error("Error: first node should be the root.");
+  }
+  _root = nodes[0];
+  
+  // arcs are added in reverse, so that OutArcIt enumerates children in pre-order
+  std::vector<Arc> inArc(nrNodes, lemon::INVALID);
+  for (uint32_t i = nrNodes - 1; i > 0; --i)
+  {
+    if (parent[i] < 0 || parent[i] >= (int32_t)i)
+    {
+      throw std::runtime_error("Error: nodes should be in pre-order.");
+    }
+    inArc[i] = _T.addArc(nodes[parent[i]], nodes[i]);
+  }
+  
+  _taxonToLeaf = NodeVector(nrTaxa, lemon::INVALID);
+  for (uint32_t i = 0; i < nrNodes; ++i)
+  {
+    const bool leaf = OutArcIt(_T, nodes[i]) == lemon::INVALID;
+    if (leaf != (taxon[i] != -1)
+        || (leaf && (taxon[i] < 0 || taxon[i] >= (int32_t)nrTaxa
+                     || _taxonToLeaf[taxon[i]] != lemon::INVALID)))
+    {
+      throw std::runtime_error("Error: invalid taxon index.");
+    }
+    if (leaf)
+    {
+      _leafToTaxon[nodes[i]] = taxon[i];
+      _taxonToLeaf[taxon[i]] = nodes[i];
+    }
+  }
+  if (std::count(_taxonToLeaf.begin(), _taxonToLeaf.end(), Node(lemon::INVALID)) > 0)
+  {
+    throw std::runtime_error("Error: number of leaves does not match number of taxa.");
+  }
+  
+  _n = n;
+  _rootState = StlIntVector(n, 0);
+  for (uint32_t i = 0; i < nrNodes; ++i)
+  {
+    for (uint32_t idx = offset[i]; idx < offset[i + 1]; ++idx)
+    {
+      const IntPair ci(changes[2 * idx], changes[2 * idx + 1]);
+      if (ci.first < 0 || ci.first >= (int)n)
+      {
+        throw std::runtime_error("Error: invalid character.");
+      }
+      
+      if (i == 0)
+      {
+        _rootState[ci.first] = ci.second;
+      }
+      else
+      {
+        _charStateLabeling[inArc[i]].insert(ci);
+        _charStateVectorLabeling[inArc[i]].push_back(ci);
+      }
+    }
+  }
+  
+  updateMatrixB();
+}
+
 void PhylogeneticTree::writeDOT(std::ostream& out) const
 {
   out << "digraph T {" << std::endl;
@@ -159,128 +403,238 @@ void PhylogeneticTree::writeDOT(std::ostream& out,
 
 void PhylogeneticTree::collapseBranches()
 {
-  bool done = false;
-  while (!done)
+  // collapsing a node does not change the out-degree of any other node,
+  // so the nodes to collapse can be identified in a single pass
+  NodeVector toCollapse;
+  for (NodeIt v(_T); v != lemon::INVALID; ++v)
   {
-    done = true;
-    for (NodeIt v(_T); v != lemon::INVALID; ++v)
+    if (v != _root && lemon::countOutArcs(_T, v) == 1)
     {
-      int outDegree = lemon::countOutArcs(_T, v);
-      if (v != _root && outDegree == 1)
-      {
-        InArcIt parentArc(_T, v);
-        Node parentNode = _T.source(parentArc);
-        OutArcIt childArc(_T, v);
-        Node childNode = _T.target(childArc);
-        
-        Arc newArc = _T.addArc(parentNode, childNode);
-        _charStateLabeling[newArc].insert(_charStateLabeling[parentArc].begin(),
-                                          _charStateLabeling[parentArc].end());
-        _charStateLabeling[newArc].insert(_charStateLabeling[childArc].begin(),
-                                          _charStateLabeling[childArc].end());
-        
-        _charStateVectorLabeling[newArc].insert(_charStateVectorLabeling[newArc].end(),
-                                                _charStateVectorLabeling[parentArc].begin(),
-                                                _charStateVectorLabeling[parentArc].end());
-        
-        _T.erase(v);
-        
-        done = false;
-        break;
-      }
+      toCollapse.push_back(v);
+    }
+  }
+  
+  for (Node v : toCollapse)
+  {
+    InArcIt parentArc(_T, v);
+    Node parentNode = _T.source(parentArc);
+    OutArcIt childArc(_T, v);
+    Node childNode = _T.target(childArc);
+    
+    Arc newArc = _T.addArc(parentNode, childNode);
+    _charStateLabeling[newArc].insert(_charStateLabeling[parentArc].begin(),
+                                      _charStateLabeling[parentArc].end());
+    _charStateLabeling[newArc].insert(_charStateLabeling[childArc].begin(),
+                                      _charStateLabeling[childArc].end());
+    
+    _charStateVectorLabeling[newArc].insert(_charStateVectorLabeling[newArc].end(),
+                                            _charStateVectorLabeling[parentArc].begin(),
+                                            _charStateVectorLabeling[parentArc].end());
+    
+    _T.erase(v);
+  }
+}
+
+void PhylogeneticTree::buildCsr(CsrTree& tree) const
+{
+  tree._node.clear();
+  tree._inArc.clear();
+  tree._parent.clear();
+  
+  // explicit stack of (node, parent index), children are pushed in reverse
+  std::vector<std::pair<Node, int> > stack(1, std::make_pair(_root, -1));
+  NodeVector children;
+  while (!stack.empty())
+  {
+    Node v = stack.back().first;
+    const int parent = stack.back().second;
+    stack.pop_back();
+    
+    const int i = tree._node.size();
+    tree._node.push_back(v);
+    tree._parent.push_back(parent);
+    tree._inArc.push_back(parent == -1 ? Arc(lemon::INVALID) : Arc(InArcIt(_T, v)));
+    
+    children.clear();
+    for (OutArcIt a(_T, v); a != lemon::INVALID; ++a)
+    {
+      children.push_back(_T.target(a));
+    }
+    for (auto it = children.rbegin(); it != children.rend(); ++it)
+    {
+      stack.push_back(std::make_pair(*it, i));
     }
   }
+  
+  // children of a node occur in pre-order, i.e. in OutArcIt order
+  const int nrNodes = tree._node.size();
+  tree._offset.assign(nrNodes + 1, 0);
+  for (int i = 1; i < nrNodes; ++i)
+  {
+    ++tree._offset[tree._parent[i] + 1];
+  }
+  for (int i = 0; i < nrNodes; ++i)
+  {
+    tree._offset[i + 1] += tree._offset[i];
+  }
+  
+  tree._child.assign(nrNodes > 0 ? nrNodes - 1 : 0, -1);
+  StlIntVector next(tree._offset.begin(), tree._offset.end() - 1);
+  for (int i = 1; i < nrNodes; ++i)
+  {
+    tree._child[next[tree._parent[i]]++] = i;
+  }
+}
+
+void PhylogeneticTree::computeIntervals(NodeVector& order,
+                                        IntNodeMap& pre,
+                                        IntNodeMap& post) const
+{
+  CsrTree tree;
+  buildCsr(tree);
+  
+  const int nrNodes = tree.size();
+  StlIntVector depth(nrNodes, 0);
+  for (int i = 1; i < nrNodes; ++i)
+  {
+    depth[i] = depth[tree._parent[i]] + 1;
+  }
+  StlIntVector size(nrNodes, 1);
+  for (int i = nrNodes - 1; i > 0; --i)
+  {
+    size[tree._parent[i]] += size[i];
+  }
+  
+  // nodes finishing before i are its descendants and the nodes preceding it
+  // in pre-order that are not its ancestors
+  for (int i = 0; i < nrNodes; ++i)
+  {
+    Node v = tree._node[i];
+    pre[v] = i;
+    post[v] = i - depth[i] + size[i] - 1;
+  }
+  
+  order.swap(tree._node);
 }
 
-void PhylogeneticTree::computePairs(TwoCharStatesSet& ancestral,
-                                    TwoCharStatesSet& incomparable,
-                                    TwoCharStatesSet& clustered,
+void PhylogeneticTree::computePairs(TwoCharStatesVector& ancestral,
+                                    TwoCharStatesVector& incomparable,
+                                    TwoCharStatesVector& clustered,
                                     bool ignoreLoss) const
 {
-  const int n = _b[_root].size();
+  ancestral.clear();
+  incomparable.clear();
+  clustered.clear();
   
-  typedef std::vector<Arc> ArcVector;
-  typedef std::vector<ArcVector> ArcMatrix;
-  typedef std::vector<ArcMatrix> Arc3Matrix;
+  const int n = _n;
   
+  // character state (c,i) has index nrStates * c + i
   const int nrStates = 2;
+  const int N = nrStates * n;
   
-  Arc3Matrix charStateToArc(n, ArcMatrix(nrStates, ArcVector()));
-  for (ArcIt a(_T); a != lemon::INVALID; ++a)
+  typedef boost::dynamic_bitset<> Bitset;
+  typedef std::vector<Bitset> BitsetVector;
+  
+  CsrTree tree;
+  buildCsr(tree);
+  const int nrNodes = tree.size();
+  
+  // label[i]: character states labeling the incoming edge of i
+  BitsetVector label(nrNodes, Bitset(N));
+  for (int i = 1; i < nrNodes; ++i)
   {
-    for (IntPair ci : _charStateLabeling[a])
+    for (IntPair ci : _charStateLabeling[tree._inArc[i]])
     {
       if (ci.second >= 2)
       {
         if (!ignoreLoss)
         {
-          ci.second = 0;
-          charStateToArc[ci.first][ci.second].push_back(a);
+          label[i].set(nrStates * ci.first);
         }
       }
       else
       {
-        charStateToArc[ci.first][ci.second].push_back(a);
+        label[i].set(nrStates * ci.first + ci.second);
       }
     }
   }
   
-  for (int c = 0; c < n; ++c)
+  // below[i]: character states labeling edges in the subtree rooted at i
+  BitsetVector below(nrNodes, Bitset(N));
+  for (int i = nrNodes - 1; i > 0; --i)
+  {
+    const int parent = tree._parent[i];
+    below[parent] |= label[i];
+    below[parent] |= below[i];
+  }
+  
+  // side[i]: character states labeling edges incomparable to the incoming edge of i
+  BitsetVector side(nrNodes, Bitset(N));
+  BitsetVector prefix, suffix;
+  for (int i = 0; i < nrNodes; ++i)
   {
-    for (int i = 0; i < nrStates; ++i)
+    const int first = tree._offset[i];
+    const int nrChildren = tree._offset[i + 1] - first;
+    prefix.assign(nrChildren + 1, side[i]);
+    suffix.assign(nrChildren + 1, Bitset(N));
+    for (int idx = 0; idx < nrChildren; ++idx)
     {
-      IntPair ci(c, i);
-
-      for (Arc a_ci : charStateToArc[c][i])
+      const int j = tree._child[first + idx];
+      prefix[idx + 1] = prefix[idx] | label[j] | below[j];
+    }
+    for (int idx = nrChildren - 1; idx >= 0; --idx)
+    {
+      const int j = tree._child[first + idx];
+      suffix[idx] = suffix[idx + 1] | label[j] | below[j];
+    }
+    for (int idx = 0; idx < nrChildren; ++idx)
+    {
+      side[tree._child[first + idx]] = prefix[idx] | suffix[idx + 1];
+    }
+  }
+  
+  // collect pairs per character state, the order of the states matches IntPair order
+  BitsetVector ancestralTo(N, Bitset(N));
+  BitsetVector incomparableTo(N, Bitset(N));
+  BitsetVector clusteredTo(N, Bitset(N));
+  for (int i = 0; i < nrNodes; ++i)
+  {
+    const Bitset& label_i = label[i];
+    for (size_t ci = label_i.find_first(); ci != Bitset::npos; ci = label_i.find_next(ci))
+    {
+      ancestralTo[ci] |= below[i];
+      incomparableTo[ci] |= side[i];
+      clusteredTo[ci] |= label_i;
+    }
+  }
+  
+  for (int ci = 0; ci < N; ++ci)
+  {
+    const IntPair ci_pair(ci / nrStates, ci % nrStates);
+    for (size_t dj = ancestralTo[ci].find_first(); dj != Bitset::npos; dj = ancestralTo[ci].find_next(dj))
+    {
+      if ((int)dj != ci)
       {
-        for (int d = 0; d < n; ++d)
-        {
-          for (int j = 0; j < nrStates; ++j)
-          {
-            IntPair dj(d, j);
-            if (ci == dj) continue;
-
-            for (Arc a_dj : charStateToArc[d][j])
-            {
-              if (isAncestral(a_ci, a_dj))
-              {
-                ancestral.insert(TwoCharStates(ci, dj));
-              }
-              else if (isClustered(a_ci, a_dj))
-              {
-                if (ci < dj)
-                {
-                  clustered.insert(TwoCharStates(ci, dj));
-                }
-              }
-              else if (isIncomparable(a_ci, a_dj))
-              {
-                if (ci < dj)
-                {
-                  incomparable.insert(TwoCharStates(ci, dj));
-                }
-              }
-            }
-          }
-        }
+        ancestral.push_back(TwoCharStates(ci_pair, IntPair(dj / nrStates, dj % nrStates)));
       }
     }
+    for (size_t dj = incomparableTo[ci].find_next(ci); dj != Bitset::npos; dj = incomparableTo[ci].find_next(dj))
+    {
+      incomparable.push_back(TwoCharStates(ci_pair, IntPair(dj / nrStates, dj % nrStates)));
+    }
+    for (size_t dj = clusteredTo[ci].find_next(ci); dj != Bitset::npos; dj = clusteredTo[ci].find_next(dj))
+    {
+      clustered.push_back(TwoCharStates(ci_pair, IntPair(dj / nrStates, dj % nrStates)));
+    }
   }
 }
 
 PhylogeneticTree::SplitSet PhylogeneticTree::getSplitSet() const
 {
-  const int m = _taxonToLeaf.size();
-  StlIntSet universe;
-  for (int p = 0; p < m; ++p)
-  {
-    universe.insert(p);
-  }
-  
   SplitSet splitSet;
   
   SplitNodeMap splitMap(_T);
-  computeSplits(_root, universe, splitMap);
+  computeSplits(splitMap);
   
   for (NodeIt v(_T); v != lemon::INVALID; ++v)
   {
@@ -293,57 +647,131 @@ PhylogeneticTree::SplitSet PhylogeneticTree::getSplitSet() const
   return splitSet;
 }
 
-void PhylogeneticTree::computeSplits(Node v,
-                                     const StlIntSet& universe,
-                                     SplitNodeMap& split) const
+StlIntVector PhylogeneticTree::getLeafOrder() const
 {
-  if (OutArcIt(_T, v) == lemon::INVALID)
+  CsrTree tree;
+  buildCsr(tree);
+  
+  StlIntVector order;
+  order.reserve(_taxonToLeaf.size());
+  for (int i = 0; i < tree.size(); ++i)
   {
-    InArcIt a(_T, v);
-
-    const int p = _leafToTaxon[v];
-
-    split[v].first.clear();
-    split[v].first.insert(p);
-    split[v].second = universe;
-    split[v].second.erase(p);
+    if (tree.isLeaf(i))
+    {
+      order.push_back(_leafToTaxon[tree._node[i]]);
+    }
   }
-  else
+  
+  return order;
+}
+
+void PhylogeneticTree::getSplitIntervals(const StlIntVector& position,
+                                         SplitIntervalVector& intervals) const
+{
+  CsrTree tree;
+  buildCsr(tree);
+  
+  intervals.clear();
+  SplitIntervalVector interval(tree.size());
+  for (int i = tree.size() - 1; i >= 0; --i)
   {
-    split[v].first.clear();
-    for (OutArcIt a(_T, v); a != lemon::INVALID; ++a)
+    SplitInterval& interval_i = interval[i];
+    if (tree.isLeaf(i))
+    {
+      interval_i._min = interval_i._max = position[_leafToTaxon[tree._node[i]]];
+      interval_i._size = 1;
+      continue;
+    }
+    
+    interval_i._min = std::numeric_limits<int>::max();
+    interval_i._max = -1;
+    interval_i._size = 0;
+    for (int idx = tree._offset[i]; idx < tree._offset[i + 1]; ++idx)
+    {
+      const SplitInterval& interval_j = interval[tree._child[idx]];
+      interval_i._min = std::min(interval_i._min, interval_j._min);
+      interval_i._max = std::max(interval_i._max, interval_j._max);
+      interval_i._size += interval_j._size;
+    }
+    
+    // as every leaf is a taxon, two nodes have the same split iff they are
+    // connected by a path of internal nodes with out-degree 1, of which
+    // only the lowest one is reported
+    const bool unaryChain = tree._offset[i + 1] - tree._offset[i] == 1
+      && !tree.isLeaf(tree._child[tree._offset[i]]);
+    if (i != 0 && !unaryChain)
     {
-      Node w = _T.target(a);
-      computeSplits(w, universe, split);
-      split[v].first.insert(split[w].first.begin(), split[w].first.end());
+      intervals.push_back(interval_i);
     }
-    std::set_difference(universe.begin(), universe.end(),
-                        split[v].first.begin(), split[v].first.end(),
-                        std::inserter(split[v].second, split[v].second.begin()));
   }
 }
 
-Matrix PhylogeneticTree::getMatrixB() const
+void PhylogeneticTree::computeSplits(SplitNodeMap& split) const
 {
   const int m = _taxonToLeaf.size();
-  const int n = _b[_root].size();
   
-  Matrix B(m, n);
-  for (int p = 0; p < m; ++p)
+  CsrTree tree;
+  buildCsr(tree);
+  
+  for (int i = tree.size() - 1; i >= 0; --i)
   {
-    Node v_p = _taxonToLeaf[p];
-    for (int c = 0; c < n; ++c)
+    Split& split_i = split[tree._node[i]];
+    split_i = Split(m);
+    if (tree.isLeaf(i))
+    {
+      split_i.set(_leafToTaxon[tree._node[i]]);
+    }
+    else
     {
-      B.setEntry(p, c, _b[v_p][c]);
+      for (int idx = tree._offset[i]; idx < tree._offset[i + 1]; ++idx)
+      {
+        split_i |= split[tree._node[tree._child[idx]]];
+      }
     }
   }
+}
+
+void PhylogeneticTree::computeLeafStates(Matrix* pA, Matrix* pB) const
+{
+  CsrTree tree;
+  buildCsr(tree);
   
-  return B;
+  visitStates(tree, [&](int i, const StlIntVector& state)
+  {
+    // node maps do not initialize nodes added later, so test for leaves
+    if (i == 0 || !tree.isLeaf(i)) return;
+    
+    const int p = _leafToTaxon[tree._node[i]];
+    
+    for (int c = 0; c < _n; ++c)
+    {
+      const int s_c = state[c];
+      if (pA)
+      {
+        pA->setEntry(p, c, s_c);
+      }
+      if (pB)
+      {
+        pB->setEntry(p, c, s_c >= 2 ? 0 : s_c);
+      }
+    }
+  });
+}
+
+void PhylogeneticTree::updateMatrixB()
+{
+  _leafB = Matrix(_taxonToLeaf.size(), _n);
+  computeLeafStates(NULL, &_leafB);
+}
+
+Matrix PhylogeneticTree::getMatrixB() const
+{
+  return _leafB;
 }
 
 int PhylogeneticTree::getParallelEvolutionCount() const
 {
-  const int n = _b[_root].size();
+  const int n = _n;
   StlIntVector parallelEvolution(n, 0);
   
   for (ArcIt a(_T); a != lemon::INVALID; ++a)
@@ -369,7 +797,7 @@ int PhylogeneticTree::getParallelEvolutionCount() const
 
 int PhylogeneticTree::getBackMutationCount() const
 {
-  const int n = _b[_root].size();
+  const int n = _n;
   StlIntVector backMutation(n, 0);
   
   for (ArcIt a(_T); a != lemon::INVALID; ++a)
@@ -398,37 +826,22 @@ std::ostream& operator<<(std::ostream& out, const PhylogeneticTree& T)
   const int nrNodes = lemon::countNodes(T._T);
   out << nrNodes << " #nodes" << std::endl;
   
-  IntNodeMap nodeToIndex(T._T, -1);
-  NodeVector indexToNode;
-  for (NodeIt v(T._T); v != lemon::INVALID; ++v)
-  {
-    nodeToIndex[v] = indexToNode.size();
-    indexToNode.push_back(v);
-  }
+  // nodes are written in pre-order, so that node states can be streamed
+  PhylogeneticTree::CsrTree tree;
+  T.buildCsr(tree);
   
-  bool first = true;
-  for (NodeIt v(T._T); v != lemon::INVALID; ++v)
+  for (int i = 0; i < nrNodes; ++i)
   {
-    if (first)
-      first = false;
-    else
+    if (i > 0)
       out << " ";
-    
-    if (v == T._root)
-    {
-      out << "-1";
-    }
-    else
-    {
-      Node u = T._T.source(InArcIt(T._T, v));
-      out << nodeToIndex[u];
-    }
+    out << tree._parent[i];
   }
   out << std::endl;
   
-  for (NodeIt v(T._T); v != lemon::INVALID; ++v)
+  T.visitStates(tree, [&](int i, const StlIntVector& state)
   {
-    if (OutArcIt(T._T, v) == lemon::INVALID)
+    Node v = tree._node[i];
+    if (tree.isLeaf(i))
     {
       out << T._leafToTaxon[v];
     }
@@ -437,20 +850,20 @@ std::ostream& operator<<(std::ostream& out, const PhylogeneticTree& T)
       out << "v" << T._T.id(v);
     }
     
-    const StlIntVector& b_v = T._b[v];
-    const int n = b_v.size();
-    for (int c = 0; c < n; ++c)
+    for (int c = 0; c < T._n; ++c)
     {
-      out << " " << b_v[c];
+      out << " " << (state[c] >= 2 ? 0 : state[c]);
     }
     out << std::endl;
-  }
+  });
   
   return out;
 }
 
 std::istream& operator>>(std::istream& in, PhylogeneticTree& T)
 {
+  typedef boost::dynamic_bitset<> Bitset;
+  
   g_lineNumber = 0;
   
   std::string line;
@@ -509,6 +922,8 @@ std::istream& operator>>(std::istream& in, PhylogeneticTree& T)
     }
   }
   
+  // node states are only needed to derive the arc labels, keep them packed
+  std::vector<Bitset> b(nrNodes);
   T._taxonToLeaf = NodeVector(nrLeaves, lemon::INVALID);
   for (int nodeIndex = 0; nodeIndex < nrNodes; ++nodeIndex)
   {
@@ -532,8 +947,8 @@ std::istream& operator>>(std::istream& in, PhylogeneticTree& T)
     
     std::vector<std::string> s;
     boost::split(s, line, boost::is_any_of(" "));
-    T._b[v] = StlIntVector(s.size() - 1, 0);
-    for (int idx = 1; idx < s.size(); ++idx)
+    b[nodeIndex] = Bitset(s.size() - 1);
+    for (size_t idx = 1; idx < s.size(); ++idx)
     {
       int val = boost::lexical_cast<int>(s[idx]);
       if (val != 0 && val != 1)
@@ -541,25 +956,33 @@ std::istream& operator>>(std::istream& in, PhylogeneticTree& T)
         throw std::runtime_error(getLineNumber()
                                  + "Error: invalid state.");
       }
-      T._b[v][idx-1] = val;
+      b[nodeIndex][idx-1] = val;
     }
   }
   
+  const Bitset& b_root = b[nodeToIndex[T._root]];
+  T._n = b_root.size();
+  T._rootState = StlIntVector(T._n, 0);
+  for (int c = 0; c < T._n; ++c)
+  {
+    T._rootState[c] = b_root[c];
+  }
+  
   for (ArcIt a(T._T); a != lemon::INVALID; ++a)
   {
-    Node u = T._T.source(a);
-    Node v = T._T.target(a);
+    const Bitset& b_u = b[nodeToIndex[T._T.source(a)]];
+    const Bitset& b_v = b[nodeToIndex[T._T.target(a)]];
     
-    assert(T._b[u].size() == T._b[v].size());
-    for (int c = 0; c < T._b[v].size(); ++c)
+    assert(b_u.size() == b_v.size());
+    const Bitset diff = b_u ^ b_v;
+    for (size_t c = diff.find_first(); c != Bitset::npos; c = diff.find_next(c))
     {
-      if (T._b[u][c] != T._b[v][c])
-      {
-        T._charStateLabeling[a].insert(IntPair(c, T._b[v][c]));
-        T._charStateVectorLabeling[a].push_back(IntPair(c, T._b[v][c]));
-      }
+      T._charStateLabeling[a].insert(IntPair(c, b_v[c]));
+      T._charStateVectorLabeling[a].push_back(IntPair(c, b_v[c]));
     }
   }
   
+  T.updateMatrixB();
+  
   return in;
 }
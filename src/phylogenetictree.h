@@ -11,6 +11,7 @@
 #include "utils.h"
 #include "matrix.h"
 #include <random>
+#include <boost/dynamic_bitset.hpp>
 
 /// This class models a character-based phylogenetic tree
 class PhylogeneticTree
@@ -19,11 +20,42 @@ public:
   /// Constructor
   PhylogeneticTree();
   
+  /// Destructor
+  virtual ~PhylogeneticTree()
+  {
+  }
+  
   /// Construct phylogenetic tree from file. Returns NULL if construction fails.
+  /// Both the text format and the binary format are supported, the latter
+  /// is detected by its magic string and loaded via a memory mapping.
   ///
   /// @param filename Filename
   static PhylogeneticTree* parse(const std::string& filename);
   
+  /// Write phylogenetic tree in binary format to output stream.
+  ///
+  /// The format uses native byte order and consists of:
+  ///   char[8]     magic string "SPHYRBT1"
+  ///   uint32[3]   number of nodes N, number of taxa m, number of characters n
+  ///   int32[N]    parent of each node in pre-order, -1 for the root
+  ///   int32[N]    taxon of each node, -1 for internal nodes
+  ///   uint32[N+1] offsets into the change list
+  ///   int32[2E]   (character, state) changes; changes of node 0 are the
+  ///               non-zero root states, changes of node i > 0 label its
+  ///               incoming arc
+  ///
+  /// @param out Output stream
+  void writeBinary(std::ostream& out) const;
+  
+  /// Read phylogenetic tree in binary format from a memory buffer
+  ///
+  /// @param data Buffer
+  /// @param size Size of the buffer in bytes
+  void readBinary(const char* data, size_t size);
+  
+  /// Magic string identifying the binary format
+  static const char* const BINARY_MAGIC;
+  
   /// Write phylogenetic tree in Graphviz DOT format to output stream
   ///
   /// @param out Output stream
@@ -38,8 +70,8 @@ public:
                 const StringVector& taxonLabel,
                 const StringVector& characterLabel) const;
   
-  /// Split, i.e. a bipartition of the leaf set
-  typedef std::pair<StlIntSet, StlIntSet> Split;
+  /// Split, i.e. a bipartition of the leaf set, given by the taxa below a node
+  typedef boost::dynamic_bitset<> Split;
   
   /// Set of all splits
   typedef std::set<Split> SplitSet;
@@ -47,20 +79,54 @@ public:
   /// Return split set
   SplitSet getSplitSet() const;
   
+  /// Split given by the range of positions of its taxa in a leaf order
+  struct SplitInterval
+  {
+    /// Minimum position
+    int _min;
+    /// Maximum position
+    int _max;
+    /// Number of taxa
+    int _size;
+    
+    /// Return whether the taxa occupy consecutive positions
+    bool isContiguous() const
+    {
+      return _max - _min + 1 == _size;
+    }
+  };
+  
+  /// Vector of split intervals
+  typedef std::vector<SplitInterval> SplitIntervalVector;
+  
+  /// Return taxa in the order in which a pre-order traversal visits the
+  /// leaves, the taxa below any node occupy consecutive positions
+  StlIntVector getLeafOrder() const;
+  
+  /// Compute one interval per distinct split of getSplitSet() in linear time
+  ///
+  /// @param position Position of each taxon in a leaf order
+  /// @param intervals Output split intervals
+  void getSplitIntervals(const StlIntVector& position,
+                         SplitIntervalVector& intervals) const;
+  
   /// Pair of character states
   typedef std::pair<IntPair, IntPair> TwoCharStates;
   
   /// Set of pairs of character states
   typedef std::set<TwoCharStates> TwoCharStatesSet;
   
+  /// Sorted vector of pairs of character states
+  typedef std::vector<TwoCharStates> TwoCharStatesVector;
+  
   /// Classifies pairs of character states as ancestral, incomparable or clustered
   ///
-  /// @param ancestral Output set composed of ordered pairs ((c,i),(d,j)) of character states such that (c,i) is ancestral to (d,j)
-  /// @param incomparable Output set composed of unordered pairs ((c,i),(d,j)) of character states such that the LCA of (c,i) and (d,j) is the root node
-  /// @param clustered Output set composed of unordered pairs ((c,i),(d,j)) of character states such that (c,i) and (d,j) label the same edge
-  void computePairs(TwoCharStatesSet& ancestral,
-                    TwoCharStatesSet& incomparable,
-                    TwoCharStatesSet& clustered,
+  /// @param ancestral Output sorted vector without duplicates composed of ordered pairs ((c,i),(d,j)) of character states such that (c,i) is ancestral to (d,j)
+  /// @param incomparable Output sorted vector without duplicates composed of unordered pairs ((c,i),(d,j)) of character states such that the LCA of (c,i) and (d,j) is the root node
+  /// @param clustered Output sorted vector without duplicates composed of unordered pairs ((c,i),(d,j)) of character states such that (c,i) and (d,j) label the same edge
+  void computePairs(TwoCharStatesVector& ancestral,
+                    TwoCharStatesVector& incomparable,
+                    TwoCharStatesVector& clustered,
                     bool ignoreLoss) const;
   
   /// Get number of character states (c,1) that label multiple edges of the tree
@@ -70,12 +136,14 @@ public:
   int getBackMutationCount() const;
   
   /// Return binary leaf labeling matrix
-  Matrix getMatrixB() const;
+  virtual Matrix getMatrixB() const;
   
   /// Return k-Dollo completion of the leaves
   virtual Matrix getMatrixA() const
   {
-    return getMatrixB();
+    Matrix A(_taxonToLeaf.size(), _n);
+    computeLeafStates(&A, NULL);
+    return A;
   }
   
 protected:
@@ -85,21 +153,116 @@ protected:
   
   typedef std::vector<Node> NodeVector;
   
-  typedef Digraph::NodeMap<StlIntVector> IntVectorNodeMap;
-  
   typedef Digraph::NodeMap<Split> SplitNodeMap;
   
   /// Remove internal nodes with out-degree 1
   void collapseBranches();
   
-  /// Compute split set for every node in the subtree rooted at v
+  /// Tree flattened into arrays in compressed sparse row (CSR) format.
+  /// Nodes are indexed in pre-order, visiting children in OutArcIt order.
+  struct CsrTree
+  {
+    /// Node of each index
+    NodeVector _node;
+    /// Incoming arc of each index, INVALID for the root
+    std::vector<Arc> _inArc;
+    /// Parent index of each index, -1 for the root
+    StlIntVector _parent;
+    /// Children of index i are _child[_offset[i]], ..., _child[_offset[i+1]-1]
+    StlIntVector _offset;
+    /// Child indices
+    StlIntVector _child;
+    
+    /// Return number of nodes
+    int size() const
+    {
+      return _node.size();
+    }
+    
+    /// Return whether the given index is a leaf
+    ///
+    /// @param i Index
+    bool isLeaf(int i) const
+    {
+      return _offset[i] == _offset[i + 1];
+    }
+  };
+  
+  /// Flatten the tree using an explicit stack
+  ///
+  /// @param tree Output flattened tree
+  void buildCsr(CsrTree& tree) const;
+  
+  /// Compute split for every node bottom-up
   ///
-  /// @param v Node
-  /// @param universe Character set
   /// @param split Split set
-  void computeSplits(Node v,
-                     const StlIntSet& universe,
-                     SplitNodeMap& split) const;
+  void computeSplits(SplitNodeMap& split) const;
+  
+  /// Compute DFS pre-order and post-order numbering of the nodes.
+  /// An edge corresponds to the interval of its target node.
+  ///
+  /// @param order Nodes in pre-order
+  /// @param pre Pre-order number
+  /// @param post Post-order number
+  void computeIntervals(NodeVector& order,
+                        IntNodeMap& pre,
+                        IntNodeMap& post) const;
+  
+  /// Compute the leaf labeling in a single DFS pass that applies the arc
+  /// labels to one working state vector. Output matrices must be sized
+  /// by the caller, entries of taxa are overwritten.
+  ///
+  /// @param pA Output leaf states, may be NULL
+  /// @param pB Output binary leaf states, may be NULL
+  void computeLeafStates(Matrix* pA, Matrix* pB) const;
+  
+  /// Recompute the binary leaf labeling _leafB
+  void updateMatrixB();
+  
+  /// Visit the nodes in pre-order together with their state vector,
+  /// obtained by applying the arc labels along the root-to-node path to the
+  /// root state. Changes are undone when leaving a subtree, so only a single
+  /// state vector of length n is kept. Labels of an arc are read when its
+  /// target is visited, so the visitor may add labels to outgoing arcs.
+  ///
+  /// @param tree Flattened tree
+  /// @param visit Function called with an index and its state vector
+  template<typename Visitor>
+  void visitStates(const CsrTree& tree, Visitor visit) const
+  {
+    StlIntVector state = _rootState;
+    // previous states of changed characters
+    IntPairVector undo;
+    // indices on the current root-to-node path and undo log size on entry
+    std::vector<std::pair<int, size_t> > path;
+    
+    const int nrNodes = tree.size();
+    for (int i = 0; i < nrNodes; ++i)
+    {
+      const int parent = tree._parent[i];
+      while (!path.empty() && path.back().first != parent)
+      {
+        for (size_t idx = undo.size(); idx > path.back().second; --idx)
+        {
+          state[undo[idx - 1].first] = undo[idx - 1].second;
+        }
+        undo.resize(path.back().second);
+        path.pop_back();
+      }
+      
+      path.push_back(std::make_pair(i, undo.size()));
+      if (parent != -1)
+      {
+        for (const IntPair& ci : _charStateLabeling[tree._inArc[i]])
+        {
+          undo.push_back(IntPair(ci.first, state[ci.first]));
+          state[ci.first] = ci.second;
+        }
+      }
+      
+      visit(i, state);
+    }
+  }
   
   /// Determine whether a_ci and a_dj are the same
   ///
@@ -114,26 +277,30 @@ protected:
   ///
   /// @param a_ci Edge
   /// @param a_dj Edge
-  bool isAncestral(Arc a_ci, Arc a_dj) const
+  /// @param pre Pre-order number
+  /// @param post Post-order number
+  bool isAncestral(Arc a_ci, Arc a_dj,
+                   const IntNodeMap& pre,
+                   const IntNodeMap& post) const
   {
-    if (a_ci == a_dj) return false;
-    
-    while (a_ci != a_dj && a_dj != lemon::INVALID)
-    {
-      Node v = _T.source(a_dj);
-      a_dj = InArcIt(_T, v);
-    }
-    
-    return a_ci == a_dj;
+    Node v = _T.target(a_ci);
+    Node w = _T.target(a_dj);
+    return pre[v] < pre[w] && post[w] < post[v];
   }
   
   /// Determine whether a_ci and a_dj occur on distinct branches
   ///
   /// @param a_ci Edge
   /// @param a_dj Edge
-  bool isIncomparable(Arc a_ci, Arc a_dj) const
+  /// @param pre Pre-order number
+  /// @param post Post-order number
+  bool isIncomparable(Arc a_ci, Arc a_dj,
+                      const IntNodeMap& pre,
+                      const IntNodeMap& post) const
   {
-    return !isAncestral(a_ci, a_dj) && !isAncestral(a_dj, a_ci);
+    return a_ci != a_dj
+      && !isAncestral(a_ci, a_dj, pre, post)
+      && !isAncestral(a_dj, a_ci, pre, post);
   }
   
 protected:
@@ -141,8 +308,10 @@ protected:
   Digraph _T;
   /// Root
   Node _root;
-  /// Node label (binary state vectors)
-  IntVectorNodeMap _b;
+  /// Number of characters
+  int _n;
+  /// State vector of the root, node states follow from the arc labels
+  StlIntVector _rootState;
   /// Character state arc labeling (unordered)
   IntPairSetArcMap _charStateLabeling;
   /// Character state arc labeling (ordered)
@@ -151,6 +320,9 @@ protected:
   NodeVector _taxonToLeaf;
   /// Leaf to taxon index mapping
   IntNodeMap _leafToTaxon;
+  /// Binary leaf labeling, computed eagerly when the tree is read so that
+  /// const access is safe from multiple threads
+  Matrix _leafB;
   
   friend std::ostream& operator<<(std::ostream& out, const PhylogeneticTree& T);
   friend std::istream& operator>>(std::istream& in, PhylogeneticTree& T);
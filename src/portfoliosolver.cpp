@@ -0,0 +1,112 @@
+/*
+ * portfoliosolver.cpp
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#include "portfoliosolver.h"
+#include <thread>
+#include <atomic>
+
+PortfolioSolver::PortfolioSolver(const Matrix& D,
+                                 int k,
+                                 bool lazy,
+                                 double alpha,
+                                 double beta)
+  : _ilp(D, k, alpha, beta)
+  , _columnGen(D, k, lazy, alpha, beta)
+  , _mutex()
+  , _incumbent()
+  , _newIncumbent(false)
+  , _solA(D.getNrTaxa(), D.getNrCharacters())
+{
+}
+
+void PortfolioSolver::init()
+{
+  _ilp.init();
+  _columnGen.init();
+  
+  _ilp.setIncumbentHandler([this](const Matrix& E)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _incumbent = E;
+    _newIncumbent = true;
+  });
+  
+  _columnGen.setHotStartProvider([this](Matrix& A)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_newIncumbent)
+    {
+      return false;
+    }
+    A = _incumbent;
+    _newIncumbent = false;
+    return true;
+  });
+}
+
+void PortfolioSolver::initHotStart(const Matrix& A)
+{
+  _ilp.initHotStart(A);
+  _columnGen.initHotStart(A);
+}
+
+bool PortfolioSolver::solve(int timeLimit,
+                            int memoryLimit,
+                            int nrThreads,
+                            bool verbose)
+{
+  int ilpThreads = nrThreads;
+  int columnGenThreads = nrThreads;
+  if (nrThreads > 1)
+  {
+    ilpThreads = nrThreads / 2;
+    columnGenThreads = nrThreads - ilpThreads;
+  }
+  
+  enum Winner { NONE, ILP, COLUMN_GEN };
+  std::atomic<int> winner(NONE);
+  
+  bool ilpRes = false;
+  std::thread ilpThread([&]()
+  {
+    ilpRes = _ilp.solve(timeLimit, memoryLimit, ilpThreads, verbose);
+    int expected = NONE;
+    if (ilpRes && _ilp.isOptimal() && winner.compare_exchange_strong(expected, ILP))
+    {
+      _columnGen.abort();
+    }
+  });
+  
+  bool columnGenRes = _columnGen.solve(timeLimit, memoryLimit, columnGenThreads, verbose);
+  int expected = NONE;
+  if (columnGenRes && winner.compare_exchange_strong(expected, COLUMN_GEN))
+  {
+    _ilp.abort();
+  }
+  ilpThread.join();
+  
+  switch (winner)
+  {
+    case ILP:
+      std::cerr << "Portfolio: optimality proven by ILP" << std::endl;
+      _solA = _ilp.getSolE();
+      return true;
+    case COLUMN_GEN:
+      std::cerr << "Portfolio: optimality proven by column generation" << std::endl;
+      _solA = _columnGen.getSolA();
+      return true;
+    default:
+      if (ilpRes)
+      {
+        // neither solver proved optimality, fall back to the ILP incumbent
+        std::cerr << "Portfolio: returning ILP incumbent" << std::endl;
+        _solA = _ilp.getSolE();
+        return true;
+      }
+      return false;
+  }
+}
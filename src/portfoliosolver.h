@@ -0,0 +1,109 @@
+/*
+ * portfoliosolver.h
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#ifndef PORTFOLIOSOLVER_H
+#define PORTFOLIOSOLVER_H
+
+#include <mutex>
+#include "matrix.h"
+#include "ilpsolverdolloflip.h"
+#include "columngenflip.h"
+
+/// This class solves the k-DPF problem by running the full ILP and column
+/// generation concurrently. The first solver that proves optimality wins and
+/// aborts the other one. Incumbents of the ILP are passed to column
+/// generation as MIP starts. Incumbents only flow in this direction: the
+/// solutions of the restricted models of column generation may violate
+/// forbidden submatrices that have not been separated yet, and the first one
+/// that is feasible for the full ILP is optimal and ends the race.
+class PortfolioSolver
+{
+public:
+  /// Constructor
+  ///
+  /// @param D Input matrix
+  /// @param k Maximum number of losses per character
+  /// @param lazy Introduce constraints into the lazy constraint pool
+  /// @param alpha False positive rate
+  /// @param beta False negative rate
+  PortfolioSolver(const Matrix& D,
+                  int k,
+                  bool lazy,
+                  double alpha,
+                  double beta);
+  
+  /// Set MIP backend of both solvers
+  ///
+  /// @param backend Backend name
+  void setBackend(const std::string& backend)
+  {
+    _ilp.setBackend(backend);
+    _columnGen.setBackend(backend);
+  }
+  
+  /// Set solver profiles. Since the ILP supplies incumbents to column
+  /// generation, it is typically given a feasibility oriented profile.
+  ///
+  /// @param ilpProfile Solver profile of the full ILP
+  /// @param columnGenProfile Solver profile of column generation
+  void setProfiles(const SolverProfile& ilpProfile,
+                   const SolverProfile& columnGenProfile)
+  {
+    _ilp.setProfile(ilpProfile);
+    _columnGen.setProfile(columnGenProfile);
+  }
+  
+  /// Set resource budget of both solvers
+  ///
+  /// @param budget Budget, may be NULL
+  void setBudget(Budget* budget)
+  {
+    _ilp.setBudget(budget);
+    _columnGen.setBudget(budget);
+  }
+  
+  /// Initialize solvers
+  void init();
+  
+  /// Provide MIP start to both solvers
+  ///
+  /// @param A k-Dollo completion
+  void initHotStart(const Matrix& A);
+  
+  /// Solve. Threads are split evenly between the two solvers.
+  ///
+  /// @param timeLimit Time limit in seconds
+  /// @param memoryLimit Memory limit in megabytes
+  /// @param nrThreads Number of threads the solvers can use
+  /// @param verbose Set to true to enable ILP solver output
+  bool solve(int timeLimit,
+             int memoryLimit,
+             int nrThreads,
+             bool verbose);
+  
+  /// Return solution matrix
+  const Matrix& getSolA() const
+  {
+    return _solA;
+  }
+  
+private:
+  /// Full ILP
+  IlpSolverDolloFlip _ilp;
+  /// Column generation
+  ColumnGenFlip _columnGen;
+  /// Mutex protecting the shared incumbent
+  std::mutex _mutex;
+  /// Most recent ILP incumbent
+  Matrix _incumbent;
+  /// Indicates whether _incumbent has not yet been passed on
+  bool _newIncumbent;
+  /// Solution matrix
+  Matrix _solA;
+};
+
+#endif // PORTFOLIOSOLVER_H
@@ -17,6 +17,7 @@ int main(int argc, char** argv)
   std::string filenameA;
   std::string filenameB;
   std::string filenameDOT;
+  std::string filenameTree;
   
   lemon::ArgParser ap(argc, argv);
   ap.refOption("k", "Maximum number of losses per character", k, true)
@@ -25,6 +26,7 @@ int main(int argc, char** argv)
     .refOption("A", "Matrix A output filename", filenameA)
     .refOption("B", "Matrix B output filename", filenameB)
     .refOption("dot", "DOT ouput filename", filenameDOT)
+    .refOption("tree", "Tree output filename (binary format)", filenameTree)
     .other("input", "Input file");
   ap.parse();
   
@@ -60,6 +62,13 @@ int main(int argc, char** argv)
     outDOT.close();
   }
 
+  if (!filenameTree.empty())
+  {
+    std::ofstream outTree(filenameTree.c_str(), std::ios::binary);
+    phyloT.writeBinary(outTree);
+    outTree.close();
+  }
+
   if (!filenameA.empty())
   {
     std::ofstream outA(filenameA.c_str());
@@ -74,7 +83,7 @@ int main(int argc, char** argv)
     outB.close();
   }
   
-  if (filenameDOT.empty() && filenameA.empty() && filenameB.empty())
+  if (filenameDOT.empty() && filenameA.empty() && filenameB.empty() && filenameTree.empty())
   {
     std::cout << phyloT.getMatrixB();
   }
@@ -0,0 +1,173 @@
+/*
+ * solverprofile.cpp
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#include "solverprofile.h"
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+SolverProfile::SolverProfile()
+  : _name("balanced")
+  , _params()
+{
+}
+
+void SolverProfile::setParam(const std::string& param, double value)
+{
+  double lb = 0, ub = 0;
+  if (param == "emphasis")
+  {
+    lb = 0;
+    ub = 4;
+  }
+  else if (param == "cuts")
+  {
+    lb = -1;
+    ub = 2;
+  }
+  else if (param == "probe")
+  {
+    lb = -1;
+    ub = 3;
+  }
+  else if (param == "heuristicfreq")
+  {
+    lb = -1;
+    ub = std::numeric_limits<int>::max();
+  }
+  else if (param == "varsel")
+  {
+    lb = -1;
+    ub = 4;
+  }
+  else if (param == "mipgap")
+  {
+    lb = 0;
+    ub = 1;
+  }
+  else
+  {
+    throw std::runtime_error("Error: unknown solver parameter '" + param + "'.");
+  }
+
+  if (!(lb <= value && value <= ub))
+  {
+    throw std::runtime_error("Error: invalid value of solver parameter '" + param + "'.");
+  }
+  _params[param] = value;
+}
+
+StringVector SolverProfile::getBuiltinProfiles()
+{
+  StringVector res;
+  res.push_back("fast");
+  res.push_back("balanced");
+  res.push_back("proof");
+  return res;
+}
+
+SolverProfile SolverProfile::getBuiltinProfile(const std::string& name)
+{
+  SolverProfile profile;
+  profile._name = name;
+  if (name == "fast")
+  {
+    // find good solutions early, spend little time on the bound
+    profile.setParam("emphasis", 1);
+    profile.setParam("cuts", -1);
+    profile.setParam("probe", -1);
+    profile.setParam("heuristicfreq", 5);
+  }
+  else if (name == "proof")
+  {
+    // close the gap, at the expense of finding incumbents late
+    profile.setParam("emphasis", 3);
+    profile.setParam("cuts", 2);
+    profile.setParam("probe", 3);
+    profile.setParam("varsel", 3);
+  }
+  else if (name != "balanced")
+  {
+    throw std::runtime_error("Error: unknown solver profile '" + name + "'.");
+  }
+  return profile;
+}
+
+bool SolverProfile::load(const std::string& nameOrFilename)
+{
+  StringVector builtin = getBuiltinProfiles();
+  if (std::find(builtin.begin(), builtin.end(), nameOrFilename) != builtin.end())
+  {
+    *this = getBuiltinProfile(nameOrFilename);
+    return true;
+  }
+
+  std::ifstream in(nameOrFilename.c_str());
+  if (!in.good())
+  {
+    std::cerr << "Error: '" << nameOrFilename
+              << "' is neither a built-in solver profile nor a readable file" << std::endl;
+    return false;
+  }
+
+  try
+  {
+    g_lineNumber = 0;
+    in >> *this;
+  }
+  catch (std::runtime_error& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return false;
+  }
+  _name = nameOrFilename;
+  return true;
+}
+
+std::ostream& operator<<(std::ostream& out, const SolverProfile& profile)
+{
+  out << "# " << profile._name << std::endl;
+  for (const auto& param : profile._params)
+  {
+    out << param.first << " " << param.second << std::endl;
+  }
+  return out;
+}
+
+std::istream& operator>>(std::istream& in, SolverProfile& profile)
+{
+  profile._params.clear();
+
+  std::string line;
+  while (in.good())
+  {
+    getline(in, line);
+    boost::trim(line);
+    if (line.empty() || line[0] == '#')
+      continue;
+
+    std::stringstream ss(line);
+    std::string param;
+    double value;
+    if (!(ss >> param >> value))
+    {
+      throw std::runtime_error(getLineNumber()
+                               + "Error: expected parameter and value.");
+    }
+
+    try
+    {
+      profile.setParam(param, value);
+    }
+    catch (std::runtime_error& e)
+    {
+      throw std::runtime_error(getLineNumber() + e.what());
+    }
+  }
+
+  return in;
+}
@@ -0,0 +1,107 @@
+/*
+ * solverprofile.h
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#ifndef SOLVERPROFILE_H
+#define SOLVERPROFILE_H
+
+#include "utils.h"
+
+/// This class encodes a named set of MIP solver parameters.
+///
+/// Parameters that are not set keep the solver default. Supported parameters
+/// (CPLEX semantics) are:
+/// - emphasis: 0 balanced, 1 feasibility, 2 optimality, 3 best bound,
+///   4 hidden feasibility
+/// - cuts: level of all cut families, -1 off, 0 auto, 1 moderate, 2 aggressive
+/// - probe: -1 off, 0 auto, 1 moderate, 2 aggressive, 3 very aggressive
+/// - heuristicfreq: -1 off, 0 auto, otherwise frequency in nodes
+/// - varsel: -1 min infeasibility, 0 auto, 1 max infeasibility,
+///   2 pseudo costs, 3 strong branching, 4 pseudo reduced costs
+/// - mipgap: relative optimality gap
+///
+/// Profiles are read from files with one "parameter value" pair per line,
+/// lines starting with '#' are ignored.
+class SolverProfile
+{
+public:
+  typedef std::map<std::string, double> ParamMap;
+
+  /// Default constructor, all parameters keep their solver default
+  SolverProfile();
+
+  /// Load built-in profile ("fast", "balanced" or "proof") or profile file
+  ///
+  /// @param nameOrFilename Profile name or filename
+  bool load(const std::string& nameOrFilename);
+
+  /// Return profile name
+  const std::string& getName() const
+  {
+    return _name;
+  }
+
+  /// Return whether parameter is set
+  ///
+  /// @param param Parameter
+  bool hasParam(const std::string& param) const
+  {
+    return _params.count(param) > 0;
+  }
+
+  /// Return parameter value
+  ///
+  /// @param param Parameter
+  double getParam(const std::string& param) const
+  {
+    assert(hasParam(param));
+    return _params.find(param)->second;
+  }
+
+  /// Set parameter, throws std::runtime_error if the parameter or value is
+  /// not supported
+  ///
+  /// @param param Parameter
+  /// @param value Value
+  void setParam(const std::string& param, double value);
+
+  /// Return parameters
+  const ParamMap& getParams() const
+  {
+    return _params;
+  }
+
+  /// Return names of built-in profiles
+  static StringVector getBuiltinProfiles();
+
+  /// Return built-in profile, throws std::runtime_error if it does not exist
+  ///
+  /// @param name Profile name
+  static SolverProfile getBuiltinProfile(const std::string& name);
+
+  friend std::ostream& operator<<(std::ostream& out, const SolverProfile& profile);
+  friend std::istream& operator>>(std::istream& in, SolverProfile& profile);
+
+private:
+  /// Profile name
+  std::string _name;
+  /// Parameters that are set
+  ParamMap _params;
+};
+
+/// Write profile
+///
+/// @param out Output stream
+/// @param profile Profile
+std::ostream& operator<<(std::ostream& out, const SolverProfile& profile);
+
+/// Read profile
+///
+/// @param in Input stream
+/// @param profile Profile
+std::istream& operator>>(std::istream& in, SolverProfile& profile);
+
+#endif // SOLVERPROFILE_H
@@ -0,0 +1,410 @@
+/*
+ * sweepmain.cpp
+ *
+ *  Created on: 19-oct-2026
+ *      Author: agent
+ */
+
+#include <lemon/arg_parser.h>
+#include <fstream>
+#include <sstream>
+#include <atomic>
+#include <mutex>
+#include <map>
+#include <memory>
+#include "dollophylogenetictree.h"
+#include "philox.h"
+
+/// Split comma-separated list, expanding ranges 'a:b' of integers. Returns
+/// false if the list is empty or a range is malformed.
+///
+/// @param str Input string
+/// @param res Values
+bool parseList(const std::string& str, StringVector& res)
+{
+  res.clear();
+  std::stringstream ss(str);
+  std::string token;
+  while (std::getline(ss, token, ','))
+  {
+    if (token.empty()) continue;
+
+    size_t pos = token.find(':');
+    if (pos == std::string::npos)
+    {
+      res.push_back(token);
+    }
+    else
+    {
+      const std::string fromStr = token.substr(0, pos);
+      const std::string toStr = token.substr(pos + 1);
+      int from, to;
+      try
+      {
+        size_t fromPos = 0, toPos = 0;
+        from = std::stoi(fromStr, &fromPos);
+        to = std::stoi(toStr, &toPos);
+        if (fromPos != fromStr.size() || toPos != toStr.size())
+        {
+          return false;
+        }
+      }
+      catch (std::logic_error&)
+      {
+        return false;
+      }
+      for (int i = from; i <= to; ++i)
+      {
+        res.push_back(std::to_string(i));
+      }
+    }
+  }
+  return !res.empty();
+}
+
+/// Return whether every value is an integer of at least the given minimum
+///
+/// @param values Values
+/// @param minValue Minimum
+bool checkIntegers(const StringVector& values, int minValue)
+{
+  for (const std::string& value : values)
+  {
+    try
+    {
+      size_t pos = 0;
+      if (std::stoi(value, &pos) < minValue || pos != value.size())
+      {
+        return false;
+      }
+    }
+    catch (std::logic_error&)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Return whether every value is a number in [0, 1]
+///
+/// @param values Values
+bool checkRates(const StringVector& values)
+{
+  for (const std::string& value : values)
+  {
+    try
+    {
+      size_t pos = 0;
+      double rate = std::stod(value, &pos);
+      if (!(0 <= rate && rate <= 1) || pos != value.size())
+      {
+        return false;
+      }
+    }
+    catch (std::logic_error&)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Grid point of the sweep
+struct Instance
+{
+  std::string _m;
+  std::string _n;
+  std::string _s;
+  std::string _k;
+  std::string _loss;
+  const Matrix* _pB;
+};
+
+/// Append row p of the given matrix to the output string
+///
+/// @param out Output string
+/// @param D Matrix
+/// @param p Taxon
+void appendRow(std::string& out, const Matrix& D, int p)
+{
+  const int n = D.getNrCharacters();
+  for (int c = 0; c < n; ++c)
+  {
+    if (c > 0) out += ' ';
+    out += std::to_string(D.getEntry(p, c));
+  }
+  out += '\n';
+}
+
+/// Open output file, returns NULL if it cannot be opened for writing
+///
+/// @param filename Filename
+/// @param error Error message
+std::unique_ptr<std::ofstream> openOutput(const std::string& filename,
+                                          std::string& error)
+{
+  std::unique_ptr<std::ofstream> pOut(new std::ofstream(filename.c_str()));
+  if (!pOut->good())
+  {
+    error = "could not open '" + filename + "' for writing";
+    pOut.reset();
+  }
+  return pOut;
+}
+
+/// Simulate a single grid point and write the A, B and perturbed B matrices.
+/// Returns false and sets the error message if the input is not a perfect
+/// phylogeny matrix or an output file cannot be written.
+///
+/// @param instance Grid point
+/// @param alphas False positive rates
+/// @param betas False negative rates
+/// @param outputDirectory Output directory
+/// @param dot Write DOT file
+/// @param error Error message
+bool simulate(const Instance& instance,
+              const StringVector& alphas,
+              const StringVector& betas,
+              const std::string& outputDirectory,
+              bool dot,
+              std::string& error)
+{
+  const int k = std::stoi(instance._k);
+  const int seed = std::stoi(instance._s);
+
+  DolloPhylogeneticTree phyloT(*instance._pB);
+  if (!phyloT.reconstructTree())
+  {
+    error = "m" + instance._m + "_n" + instance._n + "_s" + instance._s
+      + " is not a perfect phylogeny matrix";
+    return false;
+  }
+  phyloT.generateLosses(std::stod(instance._loss), k, seed);
+
+  const std::string prefix = outputDirectory + "/m" + instance._m
+    + "_n" + instance._n + "_s" + instance._s + "_k" + instance._k
+    + "_loss" + instance._loss;
+
+  if (dot)
+  {
+    std::unique_ptr<std::ofstream> pOutDOT = openOutput(prefix + ".dot", error);
+    if (!pOutDOT)
+    {
+      return false;
+    }
+    phyloT.writeDOT(*pOutDOT);
+    if (!pOutDOT->good())
+    {
+      error = "failed to write '" + prefix + ".dot'";
+      return false;
+    }
+  }
+
+  const Matrix A = phyloT.getMatrixA();
+  const Matrix B = phyloT.getMatrixB();
+  const int m = B.getNrTaxa();
+  const int n = B.getNrCharacters();
+
+  std::string header = std::to_string(m) + " #taxa\n"
+    + std::to_string(n) + " #characters\n";
+
+  // outputs[0] is A, outputs[1] is B, followed by the perturbed matrices
+  const int nrRates = alphas.size() * betas.size();
+  std::vector<double> alpha(nrRates), beta(nrRates);
+  StringVector filenames;
+  filenames.push_back(prefix + ".A");
+  filenames.push_back(prefix + ".B");
+  for (int idx = 0; idx < nrRates; ++idx)
+  {
+    const std::string& a = alphas[idx / betas.size()];
+    const std::string& b = betas[idx % betas.size()];
+    alpha[idx] = std::stod(a);
+    beta[idx] = std::stod(b);
+    filenames.push_back(prefix + "_a" + a + "_b" + b + ".B");
+  }
+
+  std::vector<std::unique_ptr<std::ofstream>> outputs;
+  for (const std::string& filename : filenames)
+  {
+    outputs.push_back(openOutput(filename, error));
+    if (!outputs.back())
+    {
+      return false;
+    }
+    *outputs.back() << header;
+  }
+
+  // every grid point with seed s uses the same noise draws, cell (p,c) draws
+  // counter (p,c) under key s for all k, loss rates and error rates, so that
+  // differences between grid points stem from the parameters rather than the
+  // noise; in particular, the flips at a smaller error rate are a subset of
+  // those at a larger rate
+  Philox4x32 philox(seed);
+  std::string rowA, rowB, rowPerturbed;
+  for (int p = 0; p < m; ++p)
+  {
+    rowA.clear();
+    rowB.clear();
+    appendRow(rowA, A, p);
+    appendRow(rowB, B, p);
+    *outputs[0] << rowA;
+    *outputs[1] << rowB;
+
+    for (int idx = 0; idx < nrRates; ++idx)
+    {
+      rowPerturbed.clear();
+      for (int c = 0; c < n; ++c)
+      {
+        int b_pc = B.getEntry(p, c);
+        const double r = philox.uniform(p, c);
+        if (b_pc == 0 && r < alpha[idx])
+        {
+          b_pc = 1;
+        }
+        else if (b_pc == 1 && r < beta[idx])
+        {
+          b_pc = 0;
+        }
+        if (c > 0) rowPerturbed += ' ';
+        rowPerturbed += std::to_string(b_pc);
+      }
+      rowPerturbed += '\n';
+      *outputs[2 + idx] << rowPerturbed;
+    }
+  }
+
+  for (size_t idx = 0; idx < outputs.size(); ++idx)
+  {
+    outputs[idx]->close();
+    if (outputs[idx]->fail())
+    {
+      error = "failed to write '" + filenames[idx] + "'";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  std::string mStr, nStr, kStr, lossStr, seedStr;
+  std::string alphaStr = "0.001";
+  std::string betaStr = "0.2";
+  std::string inputDirectory = ".";
+  std::string outputDirectory = ".";
+  int nrThreads = 1;
+  bool dot = false;
+
+  lemon::ArgParser ap(argc, argv);
+  ap.refOption("m", "Comma-separated list of number of taxa", mStr, true)
+    .refOption("n", "Comma-separated list of number of characters", nStr, true)
+    .refOption("k", "Comma-separated list of maximum number of losses per character", kStr, true)
+    .refOption("loss", "Comma-separated list of loss rates", lossStr, true)
+    .refOption("a", "Comma-separated list of false positive rates (default: 0.001)", alphaStr)
+    .refOption("b", "Comma-separated list of false negative rates (default: 0.2)", betaStr)
+    .refOption("s", "Comma-separated list of seeds, ranges 'from:to' are allowed", seedStr, true)
+    .refOption("i", "Directory with perfect phylogeny matrices 'm<m>_n<n>_s<s>.txt' (default: '.')", inputDirectory)
+    .refOption("o", "Output directory (default: '.')", outputDirectory)
+    .refOption("t", "Number of threads (default: 1)", nrThreads)
+    .refOption("dot", "Write DOT files", dot);
+  ap.parse();
+
+  // grid values are validated here, simulate converts them without checks
+  StringVector ms, ns, ks, losses, seeds, alphas, betas;
+  if (!parseList(mStr, ms) || !checkIntegers(ms, 1))
+  {
+    std::cerr << "Error: invalid number of taxa '" << mStr << "'" << std::endl;
+    return 1;
+  }
+  if (!parseList(nStr, ns) || !checkIntegers(ns, 1))
+  {
+    std::cerr << "Error: invalid number of characters '" << nStr << "'" << std::endl;
+    return 1;
+  }
+  if (!parseList(kStr, ks) || !checkIntegers(ks, 0))
+  {
+    std::cerr << "Error: invalid maximum number of losses '" << kStr << "'" << std::endl;
+    return 1;
+  }
+  if (!parseList(lossStr, losses) || !checkRates(losses))
+  {
+    std::cerr << "Error: invalid loss rates '" << lossStr << "'" << std::endl;
+    return 1;
+  }
+  if (!parseList(seedStr, seeds) || !checkIntegers(seeds, 0))
+  {
+    std::cerr << "Error: invalid seeds '" << seedStr << "'" << std::endl;
+    return 1;
+  }
+  if (!parseList(alphaStr, alphas) || !checkRates(alphas))
+  {
+    std::cerr << "Error: invalid false positive rates '" << alphaStr << "'" << std::endl;
+    return 1;
+  }
+  if (!parseList(betaStr, betas) || !checkRates(betas))
+  {
+    std::cerr << "Error: invalid false negative rates '" << betaStr << "'" << std::endl;
+    return 1;
+  }
+
+  // parse input matrices up front, parsing is not thread safe
+  std::map<std::string, Matrix> inputs;
+  std::vector<Instance> instances;
+  for (const std::string& m : ms)
+  {
+    for (const std::string& n : ns)
+    {
+      for (const std::string& s : seeds)
+      {
+        const std::string filename = inputDirectory + "/m" + m + "_n" + n + "_s" + s + ".txt";
+        std::ifstream inB(filename.c_str());
+        if (!inB.good())
+        {
+          std::cerr << "Error: could not open '" << filename << "' for reading" << std::endl;
+          return 1;
+        }
+
+        Matrix& B = inputs[filename];
+        inB >> B;
+        if (B.getMaxNrLosses() != 0)
+        {
+          std::cerr << "Error: '" << filename << "' is not a perfect phylogeny matrix" << std::endl;
+          return 1;
+        }
+
+        for (const std::string& k : ks)
+        {
+          for (const std::string& loss : losses)
+          {
+            Instance instance = {m, n, s, k, loss, &B};
+            instances.push_back(instance);
+          }
+        }
+      }
+    }
+  }
+
+  std::atomic<bool> success(true);
+  std::mutex mutex;
+  parallelForDynamic(instances.size(), nrThreads, [&](int idx)
+  {
+    std::string error;
+    if (!simulate(instances[idx], alphas, betas, outputDirectory, dot, error))
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      std::cerr << "Error: " << error << std::endl;
+      success = false;
+    }
+  });
+
+  if (!success)
+  {
+    return 1;
+  }
+
+  std::cerr << "Generated " << instances.size() << " instances" << std::endl;
+
+  return 0;
+}
@@ -7,7 +7,7 @@
 
 #include "utils.h"
 
-int g_lineNumber = 0;
+thread_local int g_lineNumber = 0;
 
 lemon::Tolerance<double> g_tol(1e-4);
 
@@ -14,6 +14,9 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <thread>
+#include <atomic>
+#include <algorithm>
 #include <lemon/list_graph.h>
 #include <lemon/tolerance.h>
 #include <lemon/time_measure.h>
@@ -45,10 +48,76 @@ std::string getLineNumber();
 /// Tolerance for floating point comparisons
 extern lemon::Tolerance<double> g_tol;
 
-/// Current line number
-extern int g_lineNumber;
+/// Current line number of the input parsed by this thread
+extern thread_local int g_lineNumber;
 
 /// Global timer
 extern lemon::Timer g_timer;
 
+/// Call f(i) for every i in [0, size), splitting the range in contiguous
+/// blocks of at least minBlockSize indices over at most nrThreads threads.
+/// Calls for distinct indices must be independent.
+///
+/// @param size Number of indices
+/// @param nrThreads Maximum number of threads, including the calling thread
+/// @param f Function
+/// @param minBlockSize Minimum number of indices per thread
+template<typename F>
+void parallelFor(int size, int nrThreads, F f, int minBlockSize = 256)
+{
+  nrThreads = std::max(1, std::min(nrThreads, size / std::max(1, minBlockSize)));
+  const int blockSize = (size + nrThreads - 1) / nrThreads;
+  
+  auto block = [&](int t)
+  {
+    const int end = std::min(size, (t + 1) * blockSize);
+    for (int i = t * blockSize; i < end; ++i)
+    {
+      f(i);
+    }
+  };
+  
+  std::vector<std::thread> threads;
+  for (int t = 1; t < nrThreads; ++t)
+  {
+    threads.emplace_back(block, t);
+  }
+  block(0);
+  for (std::thread& thread : threads)
+  {
+    thread.join();
+  }
+}
+
+/// Call f(i) for every i in [0, size) on at most nrThreads threads, which
+/// take the next index as soon as they are done. Suited for calls of
+/// unequal duration; calls for distinct indices must be independent.
+///
+/// @param size Number of indices
+/// @param nrThreads Maximum number of threads, including the calling thread
+/// @param f Function
+template<typename F>
+void parallelForDynamic(int size, int nrThreads, F f)
+{
+  std::atomic<int> next(0);
+  auto worker = [&]()
+  {
+    for (int i = next++; i < size; i = next++)
+    {
+      f(i);
+    }
+  };
+  
+  std::vector<std::thread> threads;
+  for (int t = 1; t < std::min(nrThreads, size); ++t)
+  {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (std::thread& thread : threads)
+  {
+    thread.join();
+  }
+}
+
 #endif // UTILS_H